@@ -0,0 +1,43 @@
+// Firmware of the PS2 coprocessor: polls the pad on its own and serves the register map of ps2_coprocessor.hpp to a
+// main controller, over I2C by default or over the hardware UART when PS2_COPROCESSOR_UART is defined.
+
+#include "ps2_coprocessor.hpp"
+
+#ifndef PS2_COPROCESSOR_UART
+#include "ps2_coprocessor_wire.hpp"
+#endif
+
+#ifndef PS2_COPROCESSOR_I2C_ADDRESS
+#define PS2_COPROCESSOR_I2C_ADDRESS 0x32
+#endif
+
+constexpr uint8_t       selectPin    = 10;
+constexpr uint8_t       commandPin   = 11;
+constexpr uint8_t       dataPin      = 12;
+constexpr uint8_t       clockPin     = 13;
+constexpr bool          pressureMode = true;
+constexpr bool          enableRumble = true;
+constexpr unsigned long baudRate     = 115200;
+
+ps2::Coprocessor coprocessor;
+#ifdef PS2_COPROCESSOR_UART
+ps2::SerialRegisterPort serialPort;
+#endif
+
+void setup()
+{
+#ifdef PS2_COPROCESSOR_UART
+    Serial.begin(baudRate);
+#else
+    ps2::beginWireSlave(coprocessor.registers(), PS2_COPROCESSOR_I2C_ADDRESS);
+#endif
+    coprocessor.begin(clockPin, commandPin, selectPin, dataPin, pressureMode, enableRumble);
+}
+
+void loop()
+{
+    coprocessor.poll();
+#ifdef PS2_COPROCESSOR_UART
+    serialPort.service(Serial, coprocessor.registers());
+#endif
+}
@@ -8,16 +8,16 @@ details. <http://www.gnu.org/licenses/>
 The original library code is inside archive/OriginalPS2Lib folder.
 ******************************************************************/
 
-// $$$$$$$$$$$$ DEBUG ENABLE SECTION $$$$$$$$$$$$$$$$
-// to debug ps2 controller, uncomment these two lines to print out debug to uart
-// #define PS2X_DEBUG
-// #define PS2X_COM_DEBUG
+// To debug the handshake with a controller define PS2_TRACE and dump ps2::traceBuffer, see ps2_trace.hpp.
 
 #ifndef PS2X_lib_h
 #define PS2X_lib_h
 
 #include <Arduino.h>
 
+#include "ps2_config.hpp"
+#include "ps2_trace.hpp"
+
 // Regular buttons.
 #define PSB_SELECT 0x0001u
 #define PSB_L3 0x0002u
@@ -101,6 +101,19 @@ constexpr void toggleBit(T &target, int bitNumber)
 
 namespace ps2 {
 
+class Rumble;
+class LockstepGroup;
+class SpiPoller;
+class SnapshotHistory;
+
+// Plain volatile bytes on AVR, where portOutputRegister() is a statement expression that can't appear here. The native
+// simulator declares it as a function returning registers that record every access.
+#ifdef __AVR__
+using PortRegister = volatile uint8_t *;
+#else
+using PortRegister = decltype(portOutputRegister(0));
+#endif
+
 namespace commands {
 inline constexpr byte startConfiguration[] = { 0x01, 0x43, 0x00, 0x01, 0x00 };
 inline constexpr byte setMode[]            = { 0x01, 0x44, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00 };
@@ -108,8 +121,20 @@ inline constexpr byte setAuxData[]         = { 0x01, 0x4F, 0x00, 0xFF, 0xFF, 0x0
 inline constexpr byte stopConfiguration[]  = { 0x01, 0x43, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
 inline constexpr byte enableRumble[]       = { 0x01, 0x4D, 0x00, 0x00, 0x01 };
 inline constexpr byte readType[]           = { 0x01, 0x45, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
+inline constexpr byte setDigitalMode[]     = { 0x01, 0x44, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00 };
+inline constexpr byte queryActuator[]      = { 0x01, 0x46, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A }; // Byte 3 index.
+inline constexpr byte queryMode[]          = { 0x01, 0x4C, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A }; // Byte 3 index.
 } // namespace commands
 
+// What an application needs from the pad, for configure(..., uint8_t needs). Buttons are always read. The shortest
+// frame that carries everything is chosen: 5 bytes for buttons only, 9 with sticks, 21 with pressures.
+namespace needs {
+inline constexpr uint8_t buttons   = 0x00;
+inline constexpr uint8_t sticks    = 0x01;
+inline constexpr uint8_t pressures = 0x02; // Pressure frames carry the sticks as well.
+inline constexpr uint8_t rumble    = 0x04;
+} // namespace needs
+
 enum class ErrorCode : uint8_t
 {
     Success,
@@ -118,6 +143,52 @@ enum class ErrorCode : uint8_t
     PressureModeError
 };
 
+// How long interrupts stay disabled while bits are clocked out. Longer windows give a steadier bus clock, shorter
+// windows give other ISRs lower latency. Approximate maximum interrupts-off window on a 16 MHz AVR:
+//   PerBit   - one clock edge pair, about 2 us.
+//   PerByte  - one byte, about 8 * (controlDelayUs + 2 us) = 48 us.
+//   PerFrame - whole frame including ATT setup, about 0.45 ms for 9 bytes and 1.05 ms for 21 bytes. Windows close to
+//              1 ms may drop a millis() tick. Bits are clocked by a cycle-counted loop, the steadiest bus clock.
+// Define PS2_MEASURE_INTERRUPTS_OFF to measure the actual window with maxInterruptsOffUs().
+enum class InterruptPolicy : uint8_t
+{
+    PerBit,
+    PerByte,
+    PerFrame
+};
+
+enum class FrameStatus : uint8_t
+{
+    Valid,
+    Stale,   // Wireless receiver repeats the same frame, the link is probably down.
+    Dropout  // No answer (all 0xFF) or one in another mode than configured, the last good frame is kept.
+};
+
+// Counters since configure() or resetLinkStats().
+struct LinkStats
+{
+    uint32_t      frames;
+    uint32_t      staleFrames;
+    uint32_t      droppedFrames;
+    uint16_t      dropouts;         // Times the link went from Valid to Stale or Dropout.
+    uint16_t      resyncs;          // Recoveries that only needed the next good frame.
+    uint16_t      reconfigurations; // Recoveries where the pad came back in the wrong mode and was reconfigured.
+    unsigned long longestDropoutMs;
+};
+
+// What the pad reported in configuration mode: the status query (0x45) and its actuator (0x46) and mode (0x4C)
+// tables. A pad that doesn't answer the status query leaves discovered false and is configured without it.
+struct Capabilities
+{
+    bool    discovered;
+    byte    typeId;    // 0x45 reply byte 3, 0x03 DualShock 2, 0x01 PlayStation and Guitar Hero, 0x0C wireless receiver.
+    uint8_t actuators; // Entries of the actuator table that describe a motor.
+    uint8_t modes;     // Entries of the mode table.
+    bool    digital;   // Mode table lists 0x04, 5-byte frames.
+    bool    analog;    // Mode table lists 0x07, 9-byte frames.
+    bool    pressures; // DualShock 2, 21-byte frames.
+};
+
 enum class ControllerType : uint8_t
 {
     Unknown,
@@ -129,6 +200,9 @@ enum class ControllerType : uint8_t
 class Controller
 {
 public:
+    // A pause between two readData() calls longer than this makes the next one reconfigure the pad first.
+    inline static constexpr unsigned long readPeriodUntilReconfiguration = 1500;
+
     ErrorCode      configure(uint8_t clockPin, uint8_t commandPin, uint8_t attentionPin, uint8_t dataPin);
     ErrorCode      configure(uint8_t clockPin,
                              uint8_t commandPin,
@@ -136,49 +210,172 @@ public:
                              uint8_t dataPin,
                              bool    pressureMode,
                              bool    enableRumble);
+    ErrorCode      configure(uint8_t clockPin,
+                             uint8_t commandPin,
+                             uint8_t attentionPin,
+                             uint8_t dataPin,
+                             uint8_t needs);
     ControllerType type() const;
+    Capabilities   capabilities() const;
+    uint8_t        frameBytes() const;
     bool           buttonPressed(uint16_t buttonId) const;
     bool           buttonsStateChanged() const;
     bool           buttonStateChanged(uint16_t buttonId) const;
+    uint16_t       pressedButtons() const;
+    uint16_t       changedButtons() const;
+    FrameStatus    frameStatus() const;
+    unsigned long  frameAgeMs() const;
+    LinkStats      linkStats() const;
+    void           resetLinkStats();
+    void           setStaleFrameLimit(uint8_t frames);
     byte           analogButtonState(uint16_t buttonId) const;
+    uint16_t       analogChangeMask() const;
+    bool           analogStateChanged(uint16_t buttonId) const;
+    void           setAnalogThreshold(byte threshold);
+    void           setAnalogThreshold(uint16_t buttonId, byte threshold);
+    uint16_t       pressureMask() const;
+    uint16_t       softPressureMask() const;
+    uint16_t       hardPressEdges() const;
+    uint16_t       softPressEdges() const;
+    void           setPressureThresholds(byte soft, byte hard, byte hysteresis);
+    void           setPressureThresholds(uint16_t buttonId, byte soft, byte hard, byte hysteresis);
+    unsigned long  frameStartedUs() const;
+    unsigned long  frameCompletedUs() const;
     void           readData();
     void           readData(bool motor1, byte motor2);
+    void           readData(Rumble &rumble);
+    void           decodeFrame(const byte frame[], uint8_t size, unsigned long startedUs);
     void           enableRumble();
     bool           enablePressures();
+    void           setInterruptPolicy(InterruptPolicy policy);
+    void           attachHistory(SnapshotHistory *history);
+#ifdef PS2_MEASURE_INTERRUPTS_OFF
+    unsigned long  maxInterruptsOffUs() const;
+#endif
+
+    // Bit of a PSS_* or PSAB_* value in analogChangeMask().
+    static constexpr uint16_t analogChannelMask(uint16_t buttonId) { return (1u << (buttonId - firstAnalogChannel)); }
+    // Bit of a PSAB_* value in pressureMask() and the other pressure masks.
+    static constexpr uint16_t pressureMaskBit(uint16_t buttonId) { return (1u << (buttonId - firstPressureChannel)); }
+
+private: // types
+    enum PressureLevel : uint8_t
+    {
+        SoftPress,
+        SoftRelease,
+        HardPress,
+        HardRelease
+    };
 
 private: // methods
-    ErrorCode setControllerMode(bool pressureMode, bool enableRumble);
+    friend class LockstepGroup;
+    friend class SpiPoller;
+
+    ErrorCode setControllerMode(uint8_t needs);
+    void      discoverCapabilities(const byte status[]);
+    void      queryConfiguration(const byte command[], uint8_t index, byte reply[]);
     byte      sendByte(byte inputByte);
+    void      clockByte(byte command, byte samples[8]);
+    void      byteGap() const;
+    uint8_t   beginTransfer(TraceSource source);
+    void      endTransfer(uint8_t oldSreg);
+    void      disableInterrupts();
+    void      restoreInterrupts(uint8_t oldSreg);
     void      sendCommandString(const byte string[], byte size);
     void      reconfigureController();
+    void      prepareRead();
+    void      finishRead();
+    bool      checkLink();
+    bool      adoptMode(byte mode);
+    uint16_t  frameChecksum() const;
+    void      updateAnalogChanges(uint8_t channels);
+    void      updatePressureMasks();
+    void      fillMissingSticks();
     uint8_t   maskToBitNum(uint8_t);
 
+    static byte           scaleMotor(byte level);
+    static byte           sampledByte(const byte samples[8], byte mask);
+    static uint8_t        pollFrameSize(byte mode);
+    static void           pollCommand(bool motor1, byte motor2, byte command[]);
+    static ControllerType controllerTypeOf(const byte status[]);
+
 private: // data
-    inline static constexpr unsigned long readPeriodUntilReconfiguration = 1500;
-    inline static constexpr unsigned long controlDelayUs                 = 4;
-    inline static constexpr unsigned long controlByteDelayUs             = 3;
-    inline static constexpr uint8_t       baseDataSize                   = 9;
-    inline static constexpr uint8_t       auxDataSize                    = 12;
-    inline static constexpr uint8_t       correctMode1                   = 0x41;
-    inline static constexpr uint8_t       correctMode2                   = 0x73;
-    inline static constexpr uint8_t       correctMode3                   = 0x79;
-
-    unsigned char  data_[baseDataSize + auxDataSize];
-    unsigned int   previousButtonsState_;
-    unsigned int   buttonsState_;
-    byte           clockMask_;
-    volatile byte *clockOuputRegister_;
-    byte           commandMask_;
-    volatile byte *commandOutputRegister_;
-    byte           attentionMask_;
-    volatile byte *attentionOutputRegister_;
-    byte           dataMask_;
-    volatile byte *dataInputRegister_;
-    unsigned long  lastDataReadTimestamp_;
-    byte           readDelay_;
-    ControllerType controllerType_;
-    bool           enableRumble_;
-    bool           pressureMode_;
+    inline static constexpr unsigned long controlDelayUs            = 4;
+    inline static constexpr unsigned long controlByteDelayUs        = 3;
+    inline static constexpr uint8_t       digitalDataSize           = 5;
+    inline static constexpr uint8_t       baseDataSize              = 9;
+    inline static constexpr uint8_t       auxDataSize               = 12;
+    inline static constexpr uint8_t       correctMode1              = 0x41;
+    inline static constexpr uint8_t       correctMode2              = 0x73;
+    inline static constexpr uint8_t       correctMode3              = 0x79;
+    inline static constexpr uint8_t       firstAnalogChannel        = PSS_RX;
+    inline static constexpr uint8_t       stickChannels             = 4;
+    inline static constexpr uint8_t       storedAuxSize             = (config::pressures ? auxDataSize : 0);
+    inline static constexpr uint8_t       frameSize                 = baseDataSize + storedAuxSize;
+    inline static constexpr uint8_t       analogChannels            = stickChannels + storedAuxSize;
+    inline static constexpr uint8_t       firstPressureChannel      = PSAB_PAD_RIGHT;
+    inline static constexpr byte          defaultAnalogThreshold    = 0;
+    inline static constexpr byte          defaultSoftPressure       = 0x20;
+    inline static constexpr byte          defaultHardPressure       = 0xC0;
+    inline static constexpr byte          defaultPressureHysteresis = 0x10;
+    inline static constexpr uint8_t       frameHeader               = 0x5A;
+    inline static constexpr uint8_t       defaultStaleFrameLimit    = 30;
+    inline static constexpr byte          configModeId              = 0xF3;
+    inline static constexpr byte          dualShock2TypeId          = 0x03;
+    inline static constexpr byte          guitarHeroTypeId          = 0x01;
+    inline static constexpr byte          wirelessTypeId            = 0x0C;
+    inline static constexpr byte          digitalModeId             = 0x04;
+    inline static constexpr byte          analogModeId              = 0x07;
+    inline static constexpr uint8_t       maxTableEntries           = 4;
+
+    unsigned char    data_[frameSize];
+    unsigned int     previousButtonsState_;
+    unsigned int     buttonsState_;
+    byte             clockMask_;
+    PortRegister     clockOuputRegister_;
+    byte             commandMask_;
+    PortRegister     commandOutputRegister_;
+    byte             attentionMask_;
+    PortRegister     attentionOutputRegister_;
+    byte             dataMask_;
+    PortRegister     dataInputRegister_;
+    unsigned long    lastDataReadTimestamp_;
+    unsigned long    frameStartedUs_;
+    unsigned long    frameCompletedUs_;
+    byte             readDelay_;
+    ControllerType   controllerType_;
+    bool             enableRumble_;
+    bool             pressureMode_;
+    InterruptPolicy  interruptPolicy_ = InterruptPolicy::PerBit;
+    uint16_t         analogChanged_;
+    byte             analogReference_[analogChannels];
+    byte             analogThresholds_[analogChannels];
+#if PS2_PRESSURES
+    byte             pressureThresholds_[4][auxDataSize]; // Indexed by PressureLevel.
+    uint16_t         softPressureMask_;
+    uint16_t         hardPressureMask_;
+    uint16_t         softPressEdges_;
+    uint16_t         hardPressEdges_;
+#endif
+    byte             lastGoodData_[frameSize];
+    byte             expectedMode_;
+    FrameStatus      frameStatus_;
+    uint8_t          staleFrameLimit_;
+    uint8_t          identicalFrames_;
+    uint16_t         lastChecksum_;
+    unsigned long    lastValidFrameMs_;
+    unsigned long    linkLostMs_;
+    unsigned long    lastReconfigurationMs_;
+    LinkStats        linkStats_;
+    Capabilities     capabilities_;
+    SnapshotHistory *history_ = nullptr;
+#ifdef PS2_TRACE
+    uint8_t          traceTag_;
+#endif
+#ifdef PS2_MEASURE_INTERRUPTS_OFF
+    unsigned long    interruptsOffTimestampUs_;
+    unsigned long    maxInterruptsOffUs_;
+#endif
 };
 
 } // namespace ps2
@@ -0,0 +1,49 @@
+#ifndef PS2_BUTTONS_HPP
+#define PS2_BUTTONS_HPP
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+class Controller;
+
+enum class ButtonEvent : uint8_t
+{
+    Press,
+    Release,
+    Hold // Once per press, after the button has been held for the hold delay.
+};
+
+// Called with the single PSB_* / PSG_* bit that caused the event.
+using ButtonHandler = void (*)(uint16_t button);
+
+// Calls registered handlers for the buttons that changed in the last readData(). Only the set bits of the changed
+// mask are visited, so a frame without changes costs a single compare. Handlers live in a fixed table, one slot per
+// button bit and event.
+class ButtonDispatcher
+{
+public:
+    // buttons may combine several PSB_* / PSG_* masks, the handler is registered for each of them.
+    void on(uint16_t buttons, ButtonEvent event, ButtonHandler handler);
+    void clear(uint16_t buttons, ButtonEvent event);
+    void setHoldDelay(uint16_t ms);
+    void dispatch(const Controller &controller);
+    void dispatch(const Controller &controller, unsigned long timestampMs);
+
+private: // methods
+    void call(ButtonEvent event, uint16_t buttons);
+
+private: // data
+    inline static constexpr uint8_t buttonCount = 16;
+    inline static constexpr uint8_t eventCount  = 3;
+
+    ButtonHandler handlers_[eventCount][buttonCount] = {};
+    uint16_t      registered_[eventCount]            = {}; // Buttons with a handler, per event.
+    uint16_t      holdPending_                       = 0;
+    uint16_t      pressedAtMs_[buttonCount]          = {}; // Truncated millis(), only hold delays are measured.
+    uint16_t      holdDelayMs_                       = 500;
+};
+
+} // namespace ps2
+
+#endif // PS2_BUTTONS_HPP
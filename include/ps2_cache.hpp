@@ -0,0 +1,37 @@
+#ifndef PS2_CACHE_HPP
+#define PS2_CACHE_HPP
+
+#include "ps2.hpp"
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+// Shares one controller between several readers that each need input no older than some limit. read() only polls
+// when the last frame completed at least maxAgeMs ago, so drive control, UI and telemetry reading in the same loop
+// iteration cost one bus transaction instead of three. The age is taken from frameCompletedUs(), frames read by other
+// means, e.g. LockstepGroup or SpiPoller, count as fresh too. A hit returns the same frame again, including its
+// changed-button and analog change flags.
+class FrameCache
+{
+public:
+    explicit FrameCache(Controller &controller);
+
+    const Controller &read(unsigned long maxAgeMs);
+    bool              fresh(unsigned long maxAgeMs) const;
+    void              setMotors(bool smallMotor, byte largeMotor);
+    uint32_t          hits() const;
+    uint32_t          misses() const;
+    void              resetStats();
+
+private: // data
+    Controller &controller_;
+    uint32_t    hits_       = 0;
+    uint32_t    misses_     = 0;
+    bool        smallMotor_ = false;
+    byte        largeMotor_ = 0;
+};
+
+} // namespace ps2
+
+#endif // PS2_CACHE_HPP
@@ -0,0 +1,90 @@
+#ifndef PS2_COMBO_HPP
+#define PS2_COMBO_HPP
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include <string.h>
+
+namespace ps2 {
+
+class Controller;
+
+// A chord is a single step, a sequence is up to maxSteps steps. Each step is a PSB_* mask that has to be held down
+// completely, the step is taken on the press that completes it.
+struct Combo
+{
+    inline static constexpr uint8_t maxSteps = 8;
+
+    uint16_t windowMs; // Longest time between two steps, 0 for no limit.
+    uint8_t  size;
+    uint16_t steps[maxSteps];
+};
+
+constexpr Combo chord(uint16_t buttons)
+{
+    return Combo { 0, 1, { buttons } };
+}
+
+template<typename... Steps>
+constexpr Combo sequence(uint16_t windowMs, Steps... steps)
+{
+    static_assert(sizeof...(Steps) > 0 && sizeof...(Steps) <= Combo::maxSteps, "Combo has too many steps");
+    return Combo { windowMs, static_cast<uint8_t>(sizeof...(Steps)), { static_cast<uint16_t>(steps)... } };
+}
+
+struct ComboState
+{
+    uint8_t  progress;
+    uint16_t lastStepMs; // Truncated millis().
+};
+
+inline constexpr uint16_t noCombo = 0xFFFF;
+
+// Advances every combo by one poll and returns the index of the first one that completed, or noCombo. combos is read
+// with pgm_read_*() and must be declared PROGMEM, see PS2_COMBO_TABLE().
+uint16_t advanceCombos(const Combo      combos[],
+                       ComboState       states[],
+                       uint16_t         count,
+                       const Controller &controller,
+                       unsigned long    timestampMs);
+
+// A table of N combos in flash. Declare it with PS2_COMBO_TABLE(), which is what puts the array in PROGMEM: the matcher
+// reads it with pgm_read_*(), and on AVR a table in RAM would be read from the wrong address space.
+template<uint16_t N>
+struct ComboTable
+{
+    const Combo *combos;
+};
+
+// Declares name as a ComboTable over a PROGMEM array of the given combos.
+#define PS2_COMBO_TABLE(name, ...)                                                                                     \
+    constexpr ps2::Combo name##Progmem_[] PROGMEM = { __VA_ARGS__ };                                                   \
+    constexpr ps2::ComboTable<sizeof(name##Progmem_) / sizeof(name##Progmem_[0])> name { name##Progmem_ }
+
+// Matches a constexpr table of combos against the button state, call update() once after every readData(). Polls
+// without a new press return immediately, otherwise each combo costs a few mask compares. Only 3 bytes of state are
+// kept per combo.
+//   PS2_COMBO_TABLE(combos, ps2::chord(PSB_START | PSB_SELECT),
+//                   ps2::sequence(400, PSB_PAD_DOWN, PSB_PAD_RIGHT, PSB_SQUARE));
+//   ps2::ComboRecognizer<2> recognizer(combos);
+template<uint16_t N>
+class ComboRecognizer
+{
+public:
+    explicit ComboRecognizer(const ComboTable<N> &table) : combos_ { table.combos } {}
+
+    uint16_t update(const Controller &controller) { return update(controller, millis()); }
+    uint16_t update(const Controller &controller, unsigned long timestampMs)
+    {
+        return advanceCombos(combos_, states_, N, controller, timestampMs);
+    }
+    void reset() { memset(states_, 0, sizeof(states_)); }
+
+private: // data
+    const Combo *combos_;
+    ComboState   states_[N] = {};
+};
+
+} // namespace ps2
+
+#endif // PS2_COMBO_HPP
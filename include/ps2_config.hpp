@@ -0,0 +1,50 @@
+#ifndef PS2_CONFIG_HPP
+#define PS2_CONFIG_HPP
+
+// Compile-time feature selection. Everything is enabled by default, set a macro to 0 in build_flags to remove the code
+// and data of that feature, e.g. -D PS2_PRESSURES=0 -D PS2_RUMBLE=0 for a robot that only needs buttons and sticks.
+// The API stays the same, disabled features turn into no-ops:
+//   PS2_PRESSURES       - pressure mode: the 12 aux bytes of 0x79 frames, pressure thresholds and masks. Without it
+//                         readData() never clocks more than 9 bytes and analogButtonState() of a PSAB_* returns 0.
+//   PS2_RUMBLE          - motor commands and the motor scale table, readData() always sends 0 for both motors.
+//   PS2_RECONFIGURATION - reconfiguring the pad after readPeriodUntilReconfiguration or when a wireless pad comes back
+//                         in the wrong mode. Without it such a pad stays in the mode it came back in.
+//   PS2_GUITAR_HERO     - GuitarDecoder. Without it update() ignores the frames, so lanes() and whammy() stay 0 and
+//                         no strums are reported.
+//
+// Opt-in, 0 by default because it takes an interrupt vector that the sketch or another library may define itself:
+//   PS2_SLEEP_TIMER0_COMPARE - IdleScheduler wakes on Timer0 compare B at the deadline and defines TIMER0_COMPB_vect.
+//                         Without it the scheduler only sleeps through whole Timer0 overflows and spins the rest of
+//                         each wait.
+
+#ifndef PS2_PRESSURES
+#define PS2_PRESSURES 1
+#endif
+
+#ifndef PS2_RUMBLE
+#define PS2_RUMBLE 1
+#endif
+
+#ifndef PS2_RECONFIGURATION
+#define PS2_RECONFIGURATION 1
+#endif
+
+#ifndef PS2_GUITAR_HERO
+#define PS2_GUITAR_HERO 1
+#endif
+
+#ifndef PS2_SLEEP_TIMER0_COMPARE
+#define PS2_SLEEP_TIMER0_COMPARE 0
+#endif
+
+namespace ps2 {
+namespace config {
+inline constexpr bool pressures       = (PS2_PRESSURES != 0);
+inline constexpr bool rumble          = (PS2_RUMBLE != 0);
+inline constexpr bool reconfiguration = (PS2_RECONFIGURATION != 0);
+inline constexpr bool guitarHero      = (PS2_GUITAR_HERO != 0);
+inline constexpr bool sleepCompare    = (PS2_SLEEP_TIMER0_COMPARE != 0);
+} // namespace config
+} // namespace ps2
+
+#endif // PS2_CONFIG_HPP
@@ -0,0 +1,168 @@
+#ifndef PS2_COPROCESSOR_HPP
+#define PS2_COPROCESSOR_HPP
+
+#include "ps2.hpp"
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+// Register map of a PS2 coprocessor: a small AVR that polls the pad continuously and lets a main controller read the
+// latest state over I2C or UART. Multi-byte values are little endian. Reads and writes start at a register address and
+// auto-increment. The snapshot registers are read-only, the config registers are read-write.
+namespace registers {
+inline constexpr uint8_t id              = 0x00; // Always identifier.
+inline constexpr uint8_t version         = 0x01; // Always mapVersion.
+inline constexpr uint8_t status          = 0x02; // Bits 0..1 FrameStatus, bit 7 set once configure() succeeded.
+inline constexpr uint8_t mode            = 0x03; // Mode byte of the last frame, 0x41, 0x73 or 0x79.
+inline constexpr uint8_t sequence        = 0x04; // Incremented on every poll.
+inline constexpr uint8_t buttons         = 0x05; // 2 bytes, pressed PSB_* mask, active high.
+inline constexpr uint8_t changedButtons  = 0x07; // 2 bytes, buttons that changed since this register was last read.
+inline constexpr uint8_t analogChanges   = 0x09; // 2 bytes, analogChangeMask() bits since this was last read.
+inline constexpr uint8_t pressureMask    = 0x0B; // 2 bytes, Controller::pressureMask().
+inline constexpr uint8_t sticks          = 0x0D; // 4 bytes, PSS_RX, PSS_RY, PSS_LX, PSS_LY.
+inline constexpr uint8_t pressures       = 0x11; // 12 bytes, PSAB_PAD_RIGHT..PSAB_R2.
+inline constexpr uint8_t frameAge        = 0x1D; // Controller::frameAgeMs(), saturated at 255.
+inline constexpr uint8_t snapshotEnd     = 0x1E;
+inline constexpr uint8_t pollPeriod      = 0x20; // Milliseconds between polls.
+inline constexpr uint8_t smallMotor      = 0x21; // 0 or 1.
+inline constexpr uint8_t largeMotor      = 0x22;
+inline constexpr uint8_t analogThreshold = 0x23; // Controller::setAnalogThreshold() for all channels.
+inline constexpr uint8_t end             = 0x24;
+
+inline constexpr byte    identifier = 0x50;
+inline constexpr byte    mapVersion = 1;
+inline constexpr byte    configured = 0x80;
+} // namespace registers
+
+// Two copies of the snapshot: update() fills the back copy and publishes it by flipping one index, reads always come
+// from the published copy. A read that is served from an interrupt (I2C) therefore never sees half of a poll, and the
+// read path is a plain copy without waiting for the poll loop.
+class RegisterMap
+{
+public:
+    inline static constexpr uint8_t maxBlockSize = 32; // Wire buffer size on AVR.
+
+    RegisterMap();
+
+    void    update(const Controller &controller, bool configured);
+    void    select(uint8_t address);
+    void    write(byte value);
+    uint8_t readBlock(byte *out, uint8_t maxSize);
+    bool    takeConfigChange();
+    byte    config(uint8_t address) const;
+
+private: // data
+    inline static constexpr uint8_t configSize = registers::end - registers::pollPeriod;
+
+    byte             snapshots_[2][registers::snapshotEnd];
+    byte             config_[configSize];
+    volatile uint8_t published_           = 0;
+    volatile uint8_t address_             = 0;
+    volatile bool    changesRead_[2]      = {}; // Per copy, set when the master read its change registers.
+    volatile bool    configChanged_       = false;
+    uint16_t         changedButtons_      = 0;
+    uint16_t         analogChanges_       = 0;
+    uint16_t         newButtonChanges_[2] = {}; // Per copy, changes that came in after it was published.
+    uint16_t         newAnalogChanges_[2] = {};
+    uint8_t          sequence_            = 0;
+};
+
+// Polls a controller at the rate set in the pollPeriod register and applies the other config registers.
+class Coprocessor
+{
+public:
+    ErrorCode    begin(uint8_t clockPin,
+                       uint8_t commandPin,
+                       uint8_t attentionPin,
+                       uint8_t dataPin,
+                       bool    pressureMode,
+                       bool    enableRumble);
+    void         poll();
+    RegisterMap &registers();
+    Controller  &controller();
+
+private: // data
+    Controller    controller_ {};
+    RegisterMap   registers_;
+    unsigned long lastPollMs_ = 0;
+    bool          configured_ = false;
+};
+
+// UART framing of the register map:
+//   read:  0xA5 address size         -> size bytes
+//   write: 0x5A address size data... -> nothing
+namespace serialFrame {
+inline constexpr byte read  = 0xA5;
+inline constexpr byte write = 0x5A;
+} // namespace serialFrame
+
+// Coprocessor side of the UART framing, call service() from loop().
+class SerialRegisterPort
+{
+public:
+    void service(Stream &stream, RegisterMap &registers);
+
+private: // data
+    uint8_t state_ = 0;
+    byte    command_;
+    uint8_t remaining_;
+};
+
+// Transport used by CoprocessorClient on the main controller.
+class CoprocessorLink
+{
+public:
+    virtual ~CoprocessorLink() = default;
+
+    virtual bool readRegisters(uint8_t address, byte *out, uint8_t size)         = 0;
+    virtual bool writeRegisters(uint8_t address, const byte *data, uint8_t size) = 0;
+};
+
+class StreamLink : public CoprocessorLink
+{
+public:
+    explicit StreamLink(Stream &stream, unsigned long timeoutMs = 20);
+
+    bool readRegisters(uint8_t address, byte *out, uint8_t size) override;
+    bool writeRegisters(uint8_t address, const byte *data, uint8_t size) override;
+
+private: // data
+    Stream       &stream_;
+    unsigned long timeoutMs_;
+};
+
+struct Snapshot
+{
+    FrameStatus status;
+    bool        configured;
+    byte        mode;
+    uint8_t     sequence;
+    uint16_t    buttons;
+    uint16_t    changedButtons;
+    uint16_t    analogChanges;
+    uint16_t    pressureMask;
+    byte        sticks[4];
+    byte        pressures[12];
+    uint8_t     frameAgeMs;
+};
+
+// Reference client for the main controller. readSnapshot() fetches status through frameAge in one transfer.
+class CoprocessorClient
+{
+public:
+    explicit CoprocessorClient(CoprocessorLink &link);
+
+    bool probe();
+    bool readSnapshot(Snapshot &snapshot);
+    bool setPollPeriod(uint8_t ms);
+    bool setMotors(bool smallMotor, byte largeMotor);
+    bool setAnalogThreshold(byte threshold);
+
+private: // data
+    CoprocessorLink &link_;
+};
+
+} // namespace ps2
+
+#endif // PS2_COPROCESSOR_HPP
@@ -0,0 +1,90 @@
+#ifndef PS2_COPROCESSOR_WIRE_HPP
+#define PS2_COPROCESSOR_WIRE_HPP
+
+// I2C transport of the coprocessor register map. Kept out of ps2_coprocessor.hpp so sketches that don't use I2C don't
+// link the Wire library.
+
+#include "ps2_coprocessor.hpp"
+
+#include <Wire.h>
+
+namespace ps2 {
+
+inline constexpr uint8_t defaultCoprocessorAddress = 0x32;
+
+namespace detail {
+
+inline RegisterMap *wireRegisters = nullptr;
+
+// The first byte of a master write selects the register, the rest are written from there.
+inline void wireReceive(int count)
+{
+    if (count <= 0 || Wire.available() == 0) {
+        return;
+    }
+    wireRegisters->select(static_cast<uint8_t>(Wire.read()));
+    while (Wire.available() > 0) {
+        wireRegisters->write(static_cast<byte>(Wire.read()));
+    }
+}
+
+inline void wireRequest()
+{
+    byte          block[RegisterMap::maxBlockSize];
+    const uint8_t size = wireRegisters->readBlock(block, sizeof(block));
+    Wire.write(block, size);
+}
+
+} // namespace detail
+
+// Serves registers as I2C slave at address. Requests are answered from the receive/request interrupts.
+inline void beginWireSlave(RegisterMap &registers, uint8_t address = defaultCoprocessorAddress)
+{
+    detail::wireRegisters = &registers;
+    Wire.begin(address);
+    Wire.onReceive(detail::wireReceive);
+    Wire.onRequest(detail::wireRequest);
+}
+
+// Master side, Wire.begin() must have been called. Reads are split into RegisterMap::maxBlockSize transfers.
+class WireLink : public CoprocessorLink
+{
+public:
+    explicit WireLink(uint8_t address = defaultCoprocessorAddress) : address_ { address } {}
+
+    bool readRegisters(uint8_t address, byte *out, uint8_t size) override
+    {
+        Wire.beginTransmission(address_);
+        Wire.write(address);
+        if (Wire.endTransmission(false) != 0) {
+            return false;
+        }
+        while (size > 0) {
+            const uint8_t block    = (size < RegisterMap::maxBlockSize ? size : RegisterMap::maxBlockSize);
+            const uint8_t received = Wire.requestFrom(address_, block);
+            if (received != block) {
+                return false;
+            }
+            for (uint8_t i = 0; i < block; ++i) {
+                *out++ = static_cast<byte>(Wire.read());
+            }
+            size -= block;
+        }
+        return true;
+    }
+
+    bool writeRegisters(uint8_t address, const byte *data, uint8_t size) override
+    {
+        Wire.beginTransmission(address_);
+        Wire.write(address);
+        Wire.write(data, size);
+        return (Wire.endTransmission() == 0);
+    }
+
+private: // data
+    uint8_t address_;
+};
+
+} // namespace ps2
+
+#endif // PS2_COPROCESSOR_WIRE_HPP
@@ -0,0 +1,50 @@
+#ifndef PS2_GOVERNOR_HPP
+#define PS2_GOVERNOR_HPP
+
+#include "ps2.hpp"
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+// Chooses when to poll next from input activity. Any button change, held button or stick movement beyond the analog
+// threshold switches to the active period at once; after the quiet time without activity the period doubles on every
+// poll until it reaches the idle period. The idle period is kept well below readPeriodUntilReconfiguration, so an idle
+// pad is never reconfigured.
+//
+//     if (governor.due()) {
+//         controller.readData();
+//         governor.update(controller);
+//     }
+class PollGovernor
+{
+public:
+    inline static constexpr uint16_t minPeriodMs     = 1;
+    inline static constexpr uint16_t maxIdlePeriodMs = Controller::readPeriodUntilReconfiguration / 2;
+
+    void     setPeriods(uint16_t activeMs, uint16_t idleMs);
+    void     setQuietTime(uint16_t ms);
+    bool     due() const;
+    bool     due(unsigned long timestampMs) const;
+    void     update(const Controller &controller);
+    void     update(const Controller &controller, unsigned long timestampMs);
+    uint16_t periodMs() const;
+
+private: // data
+    inline static constexpr uint16_t stickMask = Controller::analogChannelMask(PSS_RX)
+                                                 | Controller::analogChannelMask(PSS_RY)
+                                                 | Controller::analogChannelMask(PSS_LX)
+                                                 | Controller::analogChannelMask(PSS_LY);
+
+    unsigned long lastPollMs_     = 0;
+    unsigned long lastActivityMs_ = 0;
+    uint16_t      activePeriodMs_ = 4;
+    uint16_t      idlePeriodMs_   = 100;
+    uint16_t      quietMs_        = 500;
+    uint16_t      periodMs_       = 4;
+    bool          polled_         = false;
+};
+
+} // namespace ps2
+
+#endif // PS2_GOVERNOR_HPP
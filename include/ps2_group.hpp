@@ -0,0 +1,56 @@
+#ifndef PS2_GROUP_HPP
+#define PS2_GROUP_HPP
+
+#include "ps2.hpp"
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+inline constexpr uint8_t maxGroupControllers = 4;
+
+// State of every controller of a group after the same batch of polls, stored as arrays per field so that game logic
+// walking one field over all pads, e.g. the left stick X of every player, touches one contiguous run of bytes.
+struct GroupSnapshot
+{
+    uint16_t      sequence;                            // Incremented by every publish, 0 before the first.
+    uint8_t       count;                               // Controllers in the group, entries past it are 0.
+    uint8_t       validMask;                           // Bit per controller whose frame was FrameStatus::Valid.
+    unsigned long startedUs;                           // First frame of the batch started.
+    unsigned long completedUs;                         // Last frame of the batch completed.
+    uint16_t      buttons[maxGroupControllers];        // Pressed PSB_* mask.
+    uint16_t      changedButtons[maxGroupControllers]; // Controller::changedButtons().
+    byte          sticks[4][maxGroupControllers];      // [PSS_RX..PSS_LY - PSS_RX][controller].
+};
+
+// Polls a set of controllers as one batch and publishes one GroupSnapshot for all of them, so a reader never sees one
+// pad from this batch and another from the last. Like RegisterMap there are two copies: publish() fills the back one
+// and flips an index, a reader in an interrupt gets the complete previous batch while a new one is being polled.
+//
+//     group.add(player1);
+//     group.add(player2);
+//     ...
+//     group.poll();
+//     const ps2::GroupSnapshot &pads = group.snapshot();
+class ControllerGroup
+{
+public:
+    // Returns false when the group is full.
+    bool                 add(Controller &controller);
+    uint8_t              size() const;
+    void                 poll();
+    void                 publish();
+    const GroupSnapshot &snapshot() const;
+    uint16_t             sequence() const;
+
+private: // data
+    Controller      *controllers_[maxGroupControllers];
+    GroupSnapshot    snapshots_[2] = {};
+    uint16_t         sequence_     = 0;
+    uint8_t          count_        = 0;
+    volatile uint8_t published_    = 0;
+};
+
+} // namespace ps2
+
+#endif // PS2_GROUP_HPP
@@ -0,0 +1,83 @@
+#ifndef PS2_GUITAR_HPP
+#define PS2_GUITAR_HPP
+
+#include "ps2.hpp"
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+// Fret lanes, in the order of the neck.
+namespace lanes {
+inline constexpr uint8_t green  = 0x01;
+inline constexpr uint8_t red    = 0x02;
+inline constexpr uint8_t yellow = 0x04;
+inline constexpr uint8_t blue   = 0x08;
+inline constexpr uint8_t orange = 0x10;
+} // namespace lanes
+
+enum class Strum : uint8_t
+{
+    Up,
+    Down
+};
+
+struct StrumEvent
+{
+    Strum         direction;
+    uint8_t       lanes;       // Frets held in the frame that saw the strum.
+    uint16_t      windowUs;    // Time between the two polls around the strum, saturated.
+    unsigned long timestampUs; // Midpoint of those polls.
+};
+
+// Decodes Guitar Hero frames into a fret lane mask, strum events and the whammy bar. The strum bar only shows up as a
+// held bit, so the moment it was hit is only known to lie between the poll that didn't see it and the one that did;
+// its event is stamped with the midpoint, which halves the worst-case error of stamping it with the later poll. Stale
+// and dropout frames are skipped and widen the window of the next strum instead.
+//
+// Lowest latency comes from 9-byte frames (the whammy bar is in the last byte) polled back to back, readData() then
+// paces the polls at the configured read delay:
+//
+//     controller.configure(clockPin, commandPin, attentionPin, dataPin, ps2::needs::sticks);
+//     ...
+//     controller.readData();
+//     guitar.update(controller);
+//     ps2::StrumEvent strum;
+//     while (guitar.takeStrum(strum)) { ... }
+class GuitarDecoder
+{
+public:
+    inline static constexpr uint8_t queueSize = 8;
+
+    void     reset();
+    void     update(const Controller &controller);
+    void     update(uint16_t pressedButtons, byte whammy, unsigned long sampledUs);
+    uint8_t  lanes() const;
+    byte     whammy() const;
+    bool     starPower() const;
+    bool     takeStrum(StrumEvent &event);
+    uint8_t  pendingStrums() const;
+    uint16_t droppedStrums() const;
+
+    static uint8_t laneMask(uint16_t pressedButtons);
+
+private: // methods
+    void push(Strum direction, unsigned long gapUs);
+
+private: // data
+    inline static constexpr uint8_t buttonsByte = 3;
+
+    StrumEvent    queue_[queueSize];
+    unsigned long lastSampleUs_ = 0;
+    uint16_t      lastPressed_  = 0;
+    uint16_t      dropped_      = 0;
+    uint8_t       head_         = 0;
+    uint8_t       count_        = 0;
+    uint8_t       lanes_        = 0;
+    byte          whammy_       = 0;
+    bool          primed_       = false;
+};
+
+} // namespace ps2
+
+#endif // PS2_GUITAR_HPP
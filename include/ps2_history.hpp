@@ -0,0 +1,51 @@
+#ifndef PS2_HISTORY_HPP
+#define PS2_HISTORY_HPP
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+class Controller;
+
+struct HistorySnapshot
+{
+    unsigned long timestampMs; // millis() when readData() finished.
+    uint16_t      buttons;     // Pressed PSB_* mask.
+    byte          sticks[4];   // PSS_RX, PSS_RY, PSS_LX, PSS_LY.
+};
+
+// The last frames of a controller plus the last press times of every button, for gestures such as double taps, long
+// presses and stick flicks. Once attached with Controller::attachHistory() every readData() records the frame, which
+// only touches the buttons that were pressed in it. All queries are constant time and are relative to the newest
+// frame. A button already held in the first recorded frame counts as pressed at that frame.
+class SnapshotHistory
+{
+public:
+    inline static constexpr uint8_t capacity  = 8;
+    inline static constexpr uint8_t tapMemory = 3; // Press times kept per button.
+
+    void                   record(const Controller &controller, unsigned long timestampMs);
+    void                   reset();
+    uint8_t                size() const;
+    const HistorySnapshot &snapshot(uint8_t framesAgo) const;
+    unsigned long          heldMs(uint16_t button) const;
+    uint8_t                taps(uint16_t button, unsigned long windowMs) const;
+    int16_t                stickDelta(uint8_t stickId, uint8_t frames) const;
+    unsigned long          spanMs(uint8_t frames) const;
+
+private: // methods
+    static uint8_t buttonIndex(uint16_t button);
+
+private: // data
+    inline static constexpr uint8_t buttonCount = 16;
+
+    HistorySnapshot snapshots_[capacity]                  = {};
+    unsigned long   pressTimesMs_[buttonCount][tapMemory] = {}; // Newest first.
+    uint8_t         pressCounts_[buttonCount]             = {}; // Saturates at tapMemory.
+    uint8_t         newest_                               = 0;
+    uint8_t         size_                                 = 0;
+};
+
+} // namespace ps2
+
+#endif // PS2_HISTORY_HPP
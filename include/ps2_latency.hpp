@@ -0,0 +1,66 @@
+#ifndef PS2_LATENCY_HPP
+#define PS2_LATENCY_HPP
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+class Controller;
+
+// Fixed size histogram, percentiles are reported as the upper bound of their bucket. The last bucket collects
+// everything above the range, its percentiles report the maximum instead, so the range of bucketCount buckets should
+// cover the latencies of interest: the default 250 us buckets reach 8 ms.
+class LatencyHistogram
+{
+public:
+    inline static constexpr uint8_t  bucketCount          = 32;
+    inline static constexpr uint16_t defaultBucketWidthUs = 250;
+    inline static constexpr uint16_t maxCount             = 0xFFFF;
+
+    void          add(unsigned long us);
+    void          reset();
+    void          setBucketWidth(uint16_t us);
+    uint16_t      count() const;
+    unsigned long percentile(uint8_t percent) const;
+    unsigned long maximum() const;
+
+private: // data
+    uint16_t      buckets_[bucketCount] = {};
+    uint16_t      count_                = 0;
+    uint16_t      bucketWidthUs_        = defaultBucketWidthUs;
+    unsigned long maximumUs_            = 0;
+};
+
+// Splits the latency of input changes into stages:
+//   poll        - physical change until the frame that carried it started, needs the change time;
+//   transaction - frame start until frame completion;
+//   pickup      - frame completion until the application acted on it;
+//   total       - physical change until the application acted on it, needs the change time.
+// Call frameRead() after every readData() and consumed() once the application has handled the change.
+class LatencyProbe
+{
+public:
+    void                    frameRead(const Controller &controller);
+    bool                    pending() const;
+    void                    consumed(unsigned long timestampUs);
+    void                    consumed(unsigned long timestampUs, unsigned long changeTimestampUs);
+    void                    reset();
+    void                    setBucketWidth(uint16_t us);
+    const LatencyHistogram &poll() const;
+    const LatencyHistogram &transaction() const;
+    const LatencyHistogram &pickup() const;
+    const LatencyHistogram &total() const;
+
+private: // data
+    LatencyHistogram poll_;
+    LatencyHistogram transaction_;
+    LatencyHistogram pickup_;
+    LatencyHistogram total_;
+    bool             pending_          = false;
+    unsigned long    frameStartedUs_   = 0;
+    unsigned long    frameCompletedUs_ = 0;
+};
+
+} // namespace ps2
+
+#endif // PS2_LATENCY_HPP
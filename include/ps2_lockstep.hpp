@@ -0,0 +1,34 @@
+#ifndef PS2_LOCKSTEP_HPP
+#define PS2_LOCKSTEP_HPP
+
+#include "ps2.hpp"
+
+namespace ps2 {
+
+// Polls several controllers that share CLK, CMD and ATT and have their DAT lines on different bits of the same port.
+// Each clock pulse samples the port once for all of them, so N controllers are read in about the time of one frame.
+// Configure every controller on its own first; because ATT is shared, all pads see every command, so they should be
+// configured the same way. Motor values are shared as well.
+class LockstepGroup
+{
+public:
+    inline static constexpr uint8_t maxControllers = 4;
+
+    // Returns false when the group is full or the controller is not wired as described above.
+    bool    add(Controller &controller);
+    uint8_t size() const;
+    void    readData();
+    void    readData(bool motor1, byte motor2);
+
+private: // methods
+    void shiftByte(byte command, uint8_t index);
+
+private: // data
+    Controller *controllers_[maxControllers];
+    byte        dataMasks_[maxControllers];
+    uint8_t     count_ = 0;
+};
+
+} // namespace ps2
+
+#endif // PS2_LOCKSTEP_HPP
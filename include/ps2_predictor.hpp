@@ -0,0 +1,59 @@
+#ifndef PS2_PREDICTOR_HPP
+#define PS2_PREDICTOR_HPP
+
+#include "ps2.hpp"
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+// Estimates where the sticks are at a later time than the frame they came from, to make up for the poll interval and
+// the time the application takes before it acts. Each axis runs a fixed-point alpha-beta filter over the frames:
+// alpha pulls the position toward the measurement, beta the velocity. Gains are in 1/256, alpha = beta = 256 is plain
+// linear extrapolation from the last two frames. A prediction never moves further from the last measurement than the
+// overshoot limit, so a stick that stops or reverses doesn't fling the output across the range.
+//
+//     controller.readData();
+//     predictor.update(controller);
+//     const byte lx = predictor.predict(PSS_LX, micros() + actuatorDelayUs);
+class StickPredictor
+{
+public:
+    inline static constexpr uint16_t gainOne          = 256;
+    inline static constexpr uint16_t defaultAlpha     = 192;
+    inline static constexpr uint16_t defaultBeta      = 64;
+    inline static constexpr byte     defaultOvershoot = 24;
+    inline static constexpr uint16_t maxHorizonUs     = 32000; // Also the longest frame interval taken as one step.
+
+    void setGains(uint16_t alpha, uint16_t beta);
+    void setOvershootLimit(byte limit);
+    void reset();
+    void update(const Controller &controller);
+    void update(const byte sticks[4], unsigned long timestampUs);
+    byte predict(uint8_t stickId, unsigned long timestampUs) const;
+
+private: // types
+    // Position in 1/256 stick units, velocity in 1/256 stick units per 1024 us.
+    struct Axis
+    {
+        int32_t position;
+        int32_t velocity;
+        byte    measured;
+    };
+
+private: // data
+    // The velocity limit of a full stick range per 1024 us keeps velocity * maxHorizonUs inside 32 bits.
+    inline static constexpr uint8_t velocityShift = 10;
+    inline static constexpr int32_t maxVelocity   = 0xFF00;
+
+    Axis          axes_[4]        = {};
+    unsigned long lastUs_         = 0;
+    uint16_t      alpha_          = defaultAlpha;
+    uint16_t      beta_           = defaultBeta;
+    byte          overshootLimit_ = defaultOvershoot;
+    bool          primed_         = false;
+};
+
+} // namespace ps2
+
+#endif // PS2_PREDICTOR_HPP
@@ -0,0 +1,84 @@
+#ifndef PS2_RUMBLE_HPP
+#define PS2_RUMBLE_HPP
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+enum class RumbleShape : uint8_t
+{
+    Linear, // Goes from fromLevel to toLevel, constant if both are equal.
+    Decay   // Starts at fromLevel and decays exponentially, toLevel is ignored.
+};
+
+// fromLevel and toLevel drive the large motor, smallMotor switches the small one, which is only on or off, for the
+// whole step. Both levels 0 run the small motor alone.
+struct RumbleStep
+{
+    uint16_t    durationMs;
+    byte        fromLevel;
+    byte        toLevel;
+    RumbleShape shape;
+    bool        smallMotor;
+};
+
+// Fire-and-forget rumble effects for one controller. Effects are queued and played one after another, each poll
+// advances the current envelope incrementally by the time elapsed since the previous poll. Pass the object to
+// Controller::readData(Rumble&) to apply it.
+class Rumble
+{
+public:
+    // Runs the large motor at level, or with smallMotor only the small motor, on for any level but 0.
+    bool pulse(byte level, uint16_t durationMs, bool smallMotor = false);
+    bool ramp(byte fromLevel, byte toLevel, uint16_t durationMs);
+    bool decay(byte fromLevel, uint16_t durationMs);
+    // steps are not copied and must outlive the effect.
+    bool pattern(const RumbleStep steps[], uint8_t size, uint8_t repeats = 1);
+    void stop();
+    bool active() const;
+    void update(unsigned long timestampMs);
+    bool smallMotor() const;
+    byte largeMotor() const;
+
+private: // types
+    struct Effect
+    {
+        const RumbleStep *steps; // nullptr for single step effects, which use step.
+        RumbleStep        step;
+        uint8_t           size;
+        uint8_t           repeats;
+    };
+
+private: // methods
+    bool enqueue(const RumbleStep &step);
+    bool enqueue(const RumbleStep steps[], uint8_t size, uint8_t repeats);
+    static const RumbleStep &stepAt(const Effect &effect, uint8_t index);
+    void startStep(const RumbleStep &step);
+    void nextStep();
+    void advance(uint16_t ms);
+
+private: // data
+    inline static constexpr uint8_t queueSize         = 4;
+    inline static constexpr uint8_t decayTicksPerStep = 16;
+    inline static constexpr uint8_t decayShift        = 2; // Each tick keeps 3/4 of the level.
+
+    Effect        queue_[queueSize];
+    uint8_t       queueHead_      = 0;
+    uint8_t       queueCount_     = 0;
+    bool          running_        = false;
+    uint8_t       stepIndex_      = 0;
+    uint8_t       repeatsLeft_    = 0;
+    RumbleShape   shape_          = RumbleShape::Linear;
+    bool          smallMotor_     = false;
+    byte          targetLevel_    = 0;
+    uint16_t      remainingMs_    = 0;
+    uint16_t      decayTickMs_    = 0;
+    uint16_t      decayElapsedMs_ = 0;
+    int32_t       level_          = 0; // 8.8 fixed point.
+    int32_t       slope_          = 0; // 8.8 fixed point per millisecond.
+    unsigned long lastUpdateMs_   = 0;
+};
+
+} // namespace ps2
+
+#endif // PS2_RUMBLE_HPP
@@ -0,0 +1,51 @@
+#ifndef PS2_SLEEP_HPP
+#define PS2_SLEEP_HPP
+
+#include "ps2_config.hpp"
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+// Sleeps the MCU in idle mode between scheduled polls instead of spinning in delay(). Idle mode keeps Timer0, and with
+// it millis() and micros(), running: its overflow interrupt wakes the CPU every 256 ticks. Built with
+// PS2_SLEEP_TIMER0_COMPARE=1, output compare B also wakes it at the deadline and only the last tick or two are spun;
+// Timer0 compare B and its interrupt vector then belong to this class, see ps2_config.hpp.
+// Power-save mode would draw less, but stops Timer0 and with it millis(); it would need Timer2 on a watch crystal and
+// is not used.
+//
+//     scheduler.setPeriodUs(4000);
+//     ...
+//     scheduler.sleepUntilDue();
+//     controller.readData();
+class IdleScheduler
+{
+public:
+    void          setPeriodUs(unsigned long us);
+    void          sleepUntilDue();
+    void          sleepUntil(unsigned long deadlineUs);
+    void          resetStats();
+    unsigned long asleepUs() const;
+    unsigned long awakeUs() const;
+    uint16_t      dutyCyclePermille() const;
+    uint32_t      wakeups() const;
+
+private: // methods
+    void sleepOnce(unsigned long remainingUs);
+
+private: // data
+    inline static constexpr unsigned long timerTickUs = 64 / (F_CPU / 1000000UL); // Arduino sets prescaler 64.
+    inline static constexpr unsigned long overflowUs  = 256 * timerTickUs;
+    inline static constexpr unsigned long minSleepUs  = (config::sleepCompare ? 2 * timerTickUs : overflowUs);
+
+    unsigned long periodUs_     = 4000;
+    unsigned long nextDueUs_    = 0;
+    unsigned long statsStartUs_ = 0;
+    unsigned long asleepUs_     = 0;
+    uint32_t      wakeups_      = 0;
+    bool          scheduled_    = false;
+};
+
+} // namespace ps2
+
+#endif // PS2_SLEEP_HPP
@@ -0,0 +1,104 @@
+#ifndef PS2_SPI_HPP
+#define PS2_SPI_HPP
+
+#include "ps2.hpp"
+
+#include <Arduino.h>
+#include <SPI.h>
+
+namespace ps2 {
+
+class SpiClient;
+
+struct SpiTransfer
+{
+    SpiClient    *client;
+    byte         *buffer; // Sent, then overwritten with the reply.
+    uint16_t      size;
+    void        (*done)(SpiTransfer &transfer); // Called from SpiArbiter::service(), may be nullptr.
+    void         *context;
+    unsigned long queuedUs;  // Set by SpiArbiter.
+    unsigned long startedUs; // Set by SpiArbiter.
+};
+
+// One device on the shared bus with its own chip select, SPI settings and statistics of the time its transfers
+// waited in the queue.
+class SpiClient
+{
+public:
+    SpiClient(uint8_t selectPin, SPISettings settings, uint8_t selectDelayUs = 0, uint8_t byteGapUs = 0);
+
+    uint16_t      transfers() const;
+    unsigned long averageWaitUs() const;
+    unsigned long maxWaitUs() const;
+    void          resetStatistics();
+
+private: // methods
+    friend class SpiArbiter;
+
+    void begin();
+    void run(SpiTransfer &transfer);
+
+private: // data
+    SPISettings   settings_;
+    uint8_t       selectPin_;
+    uint8_t       selectDelayUs_;
+    uint8_t       byteGapUs_;
+    uint16_t      transfers_   = 0;
+    unsigned long totalWaitUs_ = 0;
+    unsigned long maxWaitUs_   = 0;
+};
+
+// Owns the SPI peripheral and runs queued transfers one at a time, each inside its own client's SPI transaction, so
+// devices with different bit order, mode and clock can share the bus. submit() never blocks; service() runs at most
+// one transfer, call it from loop().
+class SpiArbiter
+{
+public:
+    inline static constexpr uint8_t queueSize = 8;
+
+    void    begin(SpiClient *const clients[], uint8_t count);
+    bool    submit(SpiTransfer &transfer); // false when the queue is full, transfer must stay valid until done.
+    bool    service();                     // false when nothing was queued.
+    uint8_t pending() const;
+
+private: // data
+    SpiTransfer *queue_[queueSize];
+    uint8_t      head_  = 0;
+    uint8_t      count_ = 0;
+};
+
+// Polls a configured Controller over hardware SPI through the arbiter and feeds the replies to
+// Controller::decodeFrame(). ATT is the chip select. The Uno SPI pins match the default wiring (CLK 13, CMD 11,
+// DAT 12, ATT 10), so configure() can bit-bang the setup before SpiArbiter::begin() hands the pins to SPI. There is no
+// automatic reconfiguration on this path.
+class SpiPoller
+{
+public:
+    inline static constexpr uint32_t defaultClockHz = 250000;
+
+    SpiPoller(SpiArbiter &arbiter, Controller &controller, uint8_t attentionPin, uint32_t clockHz = defaultClockHz);
+
+    bool       request(bool motor1 = false, byte motor2 = 0); // false while a frame is queued.
+    bool       pending() const;
+    SpiClient &client();
+
+private: // methods
+    static void frameDone(SpiTransfer &transfer);
+
+private: // data
+    inline static constexpr uint8_t selectDelayUs = 3;
+    inline static constexpr uint8_t byteGapUs     = 10;
+    inline static constexpr uint8_t frameSize     = 21;
+
+    SpiArbiter &arbiter_;
+    Controller &controller_;
+    SpiClient   client_;
+    SpiTransfer transfer_;
+    byte        frame_[frameSize];
+    bool        pending_ = false;
+};
+
+} // namespace ps2
+
+#endif // PS2_SPI_HPP
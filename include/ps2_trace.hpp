@@ -0,0 +1,76 @@
+#ifndef PS2_TRACE_HPP
+#define PS2_TRACE_HPP
+
+// Handshake trace, compiled in only when PS2_TRACE is defined, e.g. with build_flags = -D PS2_TRACE. Every byte that
+// Controller clocks over the bus is stored as a 3 byte entry in a fixed ring buffer, which costs a few cycles per byte
+// and does not change bus timing the way printing did. Dump it afterwards with traceBuffer.dump(Serial).
+// PS2_TRACE_SIZE sets the number of entries, a power of two up to 128, 64 by default.
+
+#include <Arduino.h>
+
+namespace ps2 {
+
+enum class TraceSource : uint8_t
+{
+    Command,  // sendCommandString().
+    ReadType, // Controller type and capability queries in setControllerMode().
+    Poll,     // readData().
+    Error     // Not a bus byte: command holds the ErrorCode, response the mode byte that caused it.
+};
+
+} // namespace ps2
+
+#ifdef PS2_TRACE
+
+#ifndef PS2_TRACE_SIZE
+#define PS2_TRACE_SIZE 64
+#endif
+
+namespace ps2 {
+
+struct TraceEntry
+{
+    uint8_t tag; // TraceSource, plus frameStart on the first byte of a frame.
+    byte    command;
+    byte    response;
+};
+
+class TraceBuffer
+{
+public:
+    inline static constexpr uint8_t capacity   = PS2_TRACE_SIZE;
+    inline static constexpr uint8_t frameStart = 0x80;
+
+    static_assert(capacity > 0 && capacity <= 128 && (capacity & (capacity - 1)) == 0,
+                  "PS2_TRACE_SIZE must be a power of two up to 128");
+
+    void record(uint8_t tag, byte command, byte response)
+    {
+        TraceEntry &entry = entries_[head_];
+        entry.tag         = tag;
+        entry.command     = command;
+        entry.response    = response;
+        head_             = (head_ + 1) & (capacity - 1);
+        if (count_ < capacity) {
+            ++count_;
+        }
+    }
+
+    uint8_t    size() const;
+    TraceEntry entry(uint8_t index) const; // 0 is the oldest entry.
+    void       clear();
+    void       dump(Print &out) const;
+
+private: // data
+    TraceEntry entries_[capacity];
+    uint8_t    head_  = 0;
+    uint8_t    count_ = 0;
+};
+
+extern TraceBuffer traceBuffer;
+
+} // namespace ps2
+
+#endif // PS2_TRACE
+
+#endif // PS2_TRACE_HPP
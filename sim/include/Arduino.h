@@ -0,0 +1,91 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Host replacement of the Arduino AVR core used by the native simulator. Time is simulated, see sim/bus.hpp.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+// Set by the Arduino build, the simulated core runs at 16 MHz.
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+void          pinMode(uint8_t pin, uint8_t mode);
+void          digitalWrite(uint8_t pin, uint8_t value);
+int           digitalRead(uint8_t pin);
+long          map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+class Print
+{
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t value) = 0;
+    size_t         write(const uint8_t *buffer, size_t size);
+    size_t         print(const char text[]);
+    size_t         print(char value);
+    size_t         print(unsigned long value, int base = DEC);
+    size_t         print(long value, int base = DEC);
+    size_t         print(unsigned int value, int base = DEC);
+    size_t         print(int value, int base = DEC);
+    size_t         print(unsigned char value, int base = DEC);
+    size_t         println();
+    size_t         println(const char text[]);
+    size_t         println(char value);
+    size_t         println(unsigned long value, int base = DEC);
+    size_t         println(long value, int base = DEC);
+    size_t         println(unsigned int value, int base = DEC);
+    size_t         println(int value, int base = DEC);
+    size_t         println(unsigned char value, int base = DEC);
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read()      = 0;
+    virtual int peek()      = 0;
+};
+
+// Writes to stdout, never receives anything.
+class HardwareSerial : public Stream
+{
+public:
+    void   begin(unsigned long baudRate);
+    int    available() override;
+    int    read() override;
+    int    peek() override;
+    size_t write(uint8_t value) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#include "pins_arduino.h"
+
+#endif // Arduino_h
@@ -0,0 +1,56 @@
+#ifndef SIM_SPI_H
+#define SIM_SPI_H
+
+// Host replacement of the Arduino SPI library. Transfers clock the Uno SPI pins on the simulated bus bit by bit, so
+// devices like sim::Pad see real edges, and take the time the configured clock needs.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings
+{
+public:
+    SPISettings() = default;
+    SPISettings(uint32_t clockHz, uint8_t bitOrder, uint8_t dataMode)
+        : clockHz_ { clockHz }, bitOrder_ { bitOrder }, dataMode_ { dataMode }
+    {
+    }
+
+private: // data
+    friend class SPIClass;
+
+    uint32_t clockHz_  = 4000000;
+    uint8_t  bitOrder_ = MSBFIRST;
+    uint8_t  dataMode_ = SPI_MODE0;
+};
+
+class SPIClass
+{
+public:
+    inline static constexpr uint8_t clockPin  = 13;
+    inline static constexpr uint8_t mosiPin   = 11;
+    inline static constexpr uint8_t misoPin   = 12;
+    inline static constexpr uint8_t selectPin = 10;
+
+    void    begin();
+    void    end();
+    void    beginTransaction(SPISettings settings);
+    void    endTransaction();
+    uint8_t transfer(uint8_t value);
+    void    transfer(void *buffer, size_t size);
+
+private: // data
+    SPISettings settings_;
+};
+
+extern SPIClass SPI;
+
+#endif // SIM_SPI_H
@@ -0,0 +1,53 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+// Host replacement of the Arduino Wire library. One TwoWire object is master and slave at once: a master transfer to
+// the address passed to begin(address) runs the slave callbacks in place, and the transfer takes the time its bits
+// need at the configured clock. Transfers to other addresses are not acknowledged.
+
+#include <Arduino.h>
+
+class TwoWire : public Stream
+{
+public:
+    using ReceiveHandler = void (*)(int);
+    using RequestHandler = void (*)();
+
+    inline static constexpr uint8_t bufferSize = 32;
+
+    void    begin();
+    void    begin(uint8_t address);
+    void    end();
+    void    setClock(uint32_t clockHz);
+    void    onReceive(ReceiveHandler handler);
+    void    onRequest(RequestHandler handler);
+    void    beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+    size_t  write(uint8_t value) override;
+    size_t  write(const uint8_t *buffer, size_t size);
+    int     available() override;
+    int     read() override;
+    int     peek() override;
+
+private: // methods
+    void chargeBytes(size_t count) const;
+
+private: // data
+    uint32_t       clockHz_        = 100000;
+    int            slaveAddress_   = -1;
+    ReceiveHandler receiveHandler_ = nullptr;
+    RequestHandler requestHandler_ = nullptr;
+    uint8_t        targetAddress_  = 0;
+    bool           transmitting_   = false;
+    bool           responding_     = false;
+    uint8_t        txBuffer_[bufferSize];
+    uint8_t        txSize_         = 0;
+    uint8_t        rxBuffer_[bufferSize];
+    uint8_t        rxSize_         = 0;
+    uint8_t        rxIndex_        = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // SIM_WIRE_H
@@ -0,0 +1,19 @@
+#ifndef SIM_AVR_INTERRUPT_H
+#define SIM_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+inline void cli()
+{
+    SREG = static_cast<uint8_t>(SREG & ~(1u << SREG_I));
+}
+
+inline void sei()
+{
+    SREG = static_cast<uint8_t>(SREG | (1u << SREG_I));
+}
+
+// Interrupt handlers don't run in the simulator, an empty one only marks an interrupt that wakes from sleep.
+#define EMPTY_INTERRUPT(vector) static_assert(true, #vector)
+
+#endif // SIM_AVR_INTERRUPT_H
@@ -0,0 +1,18 @@
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include "sim/cpu.hpp"
+
+#define SREG_I 7
+#define TOIE0 0
+#define OCIE0B 2
+#define OCF0B 2
+
+#define TCNT0 (sim::timer0().counter())
+#define OCR0B (sim::timer0().compareB())
+#define TIMSK0 (sim::timer0().interruptMask())
+#define TIFR0 (sim::timer0().interruptFlags())
+
+extern sim::StatusRegister SREG;
+
+#endif // SIM_AVR_IO_H
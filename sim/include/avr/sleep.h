@@ -0,0 +1,29 @@
+#ifndef SIM_AVR_SLEEP_H
+#define SIM_AVR_SLEEP_H
+
+#include "sim/cpu.hpp"
+
+#define SLEEP_MODE_IDLE 0x00
+#define SLEEP_MODE_PWR_SAVE 0x06
+
+inline void set_sleep_mode(uint8_t mode)
+{
+    sim::sleepController().setMode(mode);
+}
+
+inline void sleep_enable()
+{
+    sim::sleepController().setEnabled(true);
+}
+
+inline void sleep_disable()
+{
+    sim::sleepController().setEnabled(false);
+}
+
+inline void sleep_cpu()
+{
+    sim::sleepController().sleep();
+}
+
+#endif // SIM_AVR_SLEEP_H
@@ -0,0 +1,17 @@
+#ifndef SIM_PINS_ARDUINO_H
+#define SIM_PINS_ARDUINO_H
+
+#include "sim/bus.hpp"
+
+#define NOT_A_PORT 0
+#define PB 2
+#define PC 3
+#define PD 4
+
+uint8_t        digitalPinToPort(uint8_t pin);
+uint8_t        digitalPinToBitMask(uint8_t pin);
+sim::Register *portOutputRegister(uint8_t port);
+sim::Register *portInputRegister(uint8_t port);
+sim::Register *portModeRegister(uint8_t port);
+
+#endif // SIM_PINS_ARDUINO_H
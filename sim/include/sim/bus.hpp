@@ -0,0 +1,122 @@
+#ifndef SIM_BUS_HPP
+#define SIM_BUS_HPP
+
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace sim {
+
+// Simulated time. Delays advance it exactly, CPU work is approximated by a fixed cost per port register access.
+// Scheduled events run when time passes them, also in the middle of a delay.
+class Clock
+{
+public:
+    uint64_t nowNs() const;
+    void     advanceNs(uint64_t ns);
+    void     schedule(uint64_t timeNs, std::function<void()> event);
+    void     reset();
+
+private: // data
+    uint64_t                                       nowNs_ = 0;
+    std::multimap<uint64_t, std::function<void()>> events_;
+};
+
+struct BusPins
+{
+    uint8_t clock;
+    uint8_t command;
+    uint8_t attention;
+    uint8_t data;
+};
+
+class Device
+{
+public:
+    virtual ~Device() = default;
+
+    virtual void pinChanged(uint8_t pin, bool level) = 0;
+};
+
+class Register
+{
+public:
+    enum class Kind : uint8_t
+    {
+        Output,
+        Input,
+        Direction
+    };
+
+    Register(uint8_t port, Kind kind);
+
+    operator uint8_t() const;
+    Register &operator=(uint8_t value);
+    Register &operator|=(uint8_t value);
+    Register &operator&=(uint8_t value);
+    Register &operator^=(uint8_t value);
+
+private: // data
+    uint8_t port_;
+    Kind    kind_;
+};
+
+// Pins and ports of an Arduino Uno. Every level change, whether caused by the sketch or by a device driving an input,
+// is reported to all attached devices.
+class Bus
+{
+public:
+    inline static constexpr uint8_t  pinCount              = 20;
+    inline static constexpr uint8_t  portCount             = 5;
+    inline static constexpr uint64_t defaultRegisterCostNs = 125; // Two cycles at 16 MHz.
+
+    Bus();
+
+    Register *outputRegister(uint8_t port);
+    Register *inputRegister(uint8_t port);
+    Register *directionRegister(uint8_t port);
+    uint8_t   portOf(uint8_t pin) const;
+    uint8_t   bitMaskOf(uint8_t pin) const;
+    uint8_t   readPort(uint8_t port, Register::Kind kind);
+    void      writePort(uint8_t port, Register::Kind kind, uint8_t value);
+    void      setPinMode(uint8_t pin, bool output);
+    void      write(uint8_t pin, bool level);
+    bool      level(uint8_t pin) const;
+    void      drive(uint8_t pin, bool level);
+    void      release(uint8_t pin);
+    void      attach(Device &device);
+    void      detach(Device &device);
+    void      setRegisterCostNs(uint64_t ns);
+    void      reset();
+
+private: // types
+    struct Pin
+    {
+        bool output      = false;
+        bool latch       = false;
+        bool driven      = false;
+        bool drivenLevel = false;
+    };
+
+private: // methods
+    uint8_t firstPinOf(uint8_t port) const;
+    uint8_t pinsOf(uint8_t port) const;
+    void    notify(uint8_t pin, bool oldLevel);
+
+private: // data
+    Pin                   pins_[pinCount];
+    std::vector<Register> outputRegisters_;
+    std::vector<Register> inputRegisters_;
+    std::vector<Register> directionRegisters_;
+    std::vector<Device *> devices_;
+    uint64_t              registerCostNs_ = defaultRegisterCostNs;
+};
+
+Clock &clock();
+Bus   &bus();
+
+} // namespace sim
+
+#endif // SIM_BUS_HPP
@@ -0,0 +1,95 @@
+#ifndef SIM_CAPTURE_HPP
+#define SIM_CAPTURE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+namespace sim {
+
+// Capture files hold raw poll frames as fixed size records behind a 16 byte header, so any record can be found from
+// its index and a file can be split into chunks without scanning it. 9-byte frames are zero-filled to 21 bytes.
+struct CaptureHeader
+{
+    char     magic[6]; // "PS2CAP"
+    uint16_t version;
+    uint16_t recordSize;
+    uint8_t  reserved[6];
+};
+
+struct CaptureRecord
+{
+    uint32_t timestampUs; // micros() when the frame completed.
+    uint8_t  size;        // 9 or 21.
+    uint8_t  reserved[3];
+    uint8_t  frame[21];
+    uint8_t  padding[3];
+};
+
+static_assert(sizeof(CaptureHeader) == 16, "capture header layout");
+static_assert(sizeof(CaptureRecord) == 32, "capture record layout");
+
+inline constexpr uint16_t captureVersion = 1;
+
+class CaptureWriter
+{
+public:
+    ~CaptureWriter();
+
+    bool open(const char *path);
+    bool add(uint32_t timestampUs, const uint8_t *frame, uint8_t size);
+    bool close();
+
+private: // data
+    FILE *file_ = nullptr;
+};
+
+// Read-only memory map of a capture file.
+class CaptureFile
+{
+public:
+    ~CaptureFile();
+
+    bool                 open(const char *path);
+    void                 close();
+    size_t               frames() const;
+    const CaptureRecord *records() const;
+
+private: // data
+    void  *mapping_ = nullptr;
+    size_t size_    = 0;
+    size_t frames_  = 0;
+};
+
+// Columns of decoded frames. analog[0..3] are PSS_RX..PSS_LY and analog[4..15] the pressures PSAB_PAD_RIGHT..PSAB_R2,
+// the same layout as Controller::analogChangeMask(). Change masks compare with the previous record of the file, the
+// first record counts as unchanged.
+struct FrameColumns
+{
+    std::vector<uint32_t> timestampUs;
+    std::vector<uint8_t>  mode;
+    std::vector<uint16_t> buttons;        // Active high PSB_* mask.
+    std::vector<uint16_t> changedButtons; // PSB_* bits that differ from the previous frame.
+    std::vector<uint16_t> analogChanges;  // Channels that differ from the previous frame.
+    std::vector<uint8_t>  analog[16];
+
+    void resize(size_t frames);
+};
+
+enum class DecodeKernel : uint8_t
+{
+    Scalar,
+    Sse2
+};
+
+bool kernelAvailable(DecodeKernel kernel);
+// Decodes records first..first + count - 1 into the same rows of columns, which must be resized to frames().
+void decodeFrames(const CaptureFile &file, size_t first, size_t count, FrameColumns &columns, DecodeKernel kernel);
+// Splits the file into one chunk per thread, chunks share nothing but the read-only mapping.
+void decodeParallel(const CaptureFile &file, FrameColumns &columns, unsigned threads, DecodeKernel kernel);
+
+} // namespace sim
+
+#endif // SIM_CAPTURE_HPP
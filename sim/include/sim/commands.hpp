@@ -0,0 +1,29 @@
+#ifndef SIM_COMMANDS_HPP
+#define SIM_COMMANDS_HPP
+
+namespace sim {
+
+// Each command receives the arguments following its name.
+int traceCommand(int argc, char *argv[]);
+int latencyCommand(int argc, char *argv[]);
+int lockstepCommand(int argc, char *argv[]);
+int spiCommand(int argc, char *argv[]);
+int linkCommand(int argc, char *argv[]);
+int coprocessorCommand(int argc, char *argv[]);
+int governorCommand(int argc, char *argv[]);
+int featuresCommand(int argc, char *argv[]);
+int cacheCommand(int argc, char *argv[]);
+int faultsCommand(int argc, char *argv[]);
+int recordCommand(int argc, char *argv[]);
+int decodeCommand(int argc, char *argv[]);
+int historyCommand(int argc, char *argv[]);
+int predictCommand(int argc, char *argv[]);
+int capabilitiesCommand(int argc, char *argv[]);
+int sleepCommand(int argc, char *argv[]);
+int guitarCommand(int argc, char *argv[]);
+int groupCommand(int argc, char *argv[]);
+int apiCommand(int argc, char *argv[]);
+
+} // namespace sim
+
+#endif // SIM_COMMANDS_HPP
@@ -0,0 +1,82 @@
+#ifndef SIM_CPU_HPP
+#define SIM_CPU_HPP
+
+#include <stdint.h>
+
+namespace sim {
+
+// SREG of the simulated AVR. Only the I bit has a meaning, every interrupts-off window is measured in simulated time.
+class StatusRegister
+{
+public:
+    inline static constexpr uint8_t interruptBit = 7;
+
+    operator uint8_t() const;
+    StatusRegister &operator=(uint8_t value);
+
+    bool     interruptsEnabled() const;
+    uint64_t maxInterruptsOffNs() const;
+    uint64_t totalInterruptsOffNs() const;
+    void     resetStatistics();
+
+private: // data
+    uint8_t  value_                = (1u << interruptBit);
+    uint64_t interruptsOffSinceNs_ = 0;
+    uint64_t maxInterruptsOffNs_   = 0;
+    uint64_t totalInterruptsOffNs_ = 0;
+};
+
+// Timer0 as the Arduino core runs it at 16 MHz: prescaler 64, one tick every 4 us, the overflow interrupt that keeps
+// millis() is always enabled. The counter follows simulated time, the registers hold what the sketch writes.
+class Timer0
+{
+public:
+    inline static constexpr uint64_t tickNs         = 4000;
+    inline static constexpr uint8_t  overflowEnable = 0; // TOIE0
+    inline static constexpr uint8_t  compareBEnable = 2; // OCIE0B
+
+    uint8_t  counter() const;
+    uint8_t &compareB();
+    uint8_t &interruptMask();
+    uint8_t &interruptFlags();
+    uint64_t nextInterruptNs(bool &compareMatch) const;
+    void     reset();
+
+private: // data
+    uint8_t compareB_       = 0;
+    uint8_t interruptMask_  = (1u << overflowEnable);
+    uint8_t interruptFlags_ = 0;
+};
+
+// SMCR and the SLEEP instruction as avr/sleep.h uses them. Sleeping advances simulated time to the next Timer0
+// interrupt. Only idle mode keeps Timer0 running; a sleep in another mode, without sleep_enable() or with interrupts
+// off would not wake on the chip and is counted as a lockup, time still moves on to keep the simulation going.
+class SleepController
+{
+public:
+    struct Stats
+    {
+        uint32_t sleeps;
+        uint32_t compareWakeups;
+        uint32_t lockups;
+        uint64_t sleptNs;
+    };
+
+    void         setMode(uint8_t mode);
+    void         setEnabled(bool enabled);
+    void         sleep();
+    const Stats &stats() const;
+    void         reset();
+
+private: // data
+    uint8_t mode_    = 0;
+    bool    enabled_ = false;
+    Stats   stats_   = {};
+};
+
+Timer0          &timer0();
+SleepController &sleepController();
+
+} // namespace sim
+
+#endif // SIM_CPU_HPP
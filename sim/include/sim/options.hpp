@@ -0,0 +1,15 @@
+#ifndef SIM_OPTIONS_HPP
+#define SIM_OPTIONS_HPP
+
+#include <stdint.h>
+
+namespace sim {
+
+// Minimal "--name value" parsing for the simulator commands.
+const char *optionValue(int argc, char *argv[], const char *name, const char *defaultValue);
+uint64_t    optionNumber(int argc, char *argv[], const char *name, uint64_t defaultValue);
+bool        optionFlag(int argc, char *argv[], const char *name);
+
+} // namespace sim
+
+#endif // SIM_OPTIONS_HPP
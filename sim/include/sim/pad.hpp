@@ -0,0 +1,109 @@
+#ifndef SIM_PAD_HPP
+#define SIM_PAD_HPP
+
+#include "sim/bus.hpp"
+
+namespace sim {
+
+// DualShock 2 answering on the simulated bus. It shifts data out on falling CLK edges and samples CMD on rising edges,
+// like the real pad. Button state is set by the scenario, active high.
+class Pad : public Device
+{
+public:
+    enum class Mode : uint8_t
+    {
+        Digital  = 0x41,
+        Analog   = 0x73,
+        Pressure = 0x79,
+        Config   = 0xF3
+    };
+
+    // Faults of a real bus, each one lasts for a number of frames:
+    //   BitFlip        - bit of response byte byteIndex is inverted.
+    //   MissingAck     - the pad stops answering from byteIndex on, the rest of the frame reads 0xFF.
+    //   SlowConfigExit - the pad ignores that many exit config commands and stays in config mode.
+    //   Unplug         - the pad is pulled at byteIndex of the next frame, misses that many frames and comes back
+    //                    power cycled.
+    //   ReceiverIdle   - a wireless receiver answers 0xFF for every byte, header included.
+    enum class Fault : uint8_t
+    {
+        None,
+        BitFlip,
+        MissingAck,
+        SlowConfigExit,
+        Unplug,
+        ReceiverIdle
+    };
+
+    inline static constexpr uint8_t maxFrameSize = 21;
+
+    Pad(uint8_t clockPin, uint8_t commandPin, uint8_t attentionPin, uint8_t dataPin);
+    ~Pad() override;
+
+    void     press(uint16_t buttons, uint8_t pressure = 0xFF);
+    void     release(uint16_t buttons);
+    void     setStick(uint8_t stickId, uint8_t value);
+    void     setPressure(uint8_t buttonId, uint8_t value);
+    // Byte 3 of the status reply (0x45), 0x03 for a DualShock 2, 0x0C for a wireless receiver.
+    void     setTypeId(uint8_t typeId);
+    // Bytes 4 and 6 of the status reply, the entries of the mode (0x4C) and actuator (0x46) tables, 2 and 2 by default.
+    void     setTableSizes(uint8_t modes, uint8_t actuators);
+    uint16_t buttons() const;
+    Mode     mode() const;
+    uint8_t  smallMotor() const;
+    uint8_t  largeMotor() const;
+    uint32_t frames() const;
+    // A disconnected pad leaves DAT floating, like a receiver that lost the radio link.
+    void     setConnected(bool connected);
+    // Back to digital mode without rumble and pressures, as after the pad was switched off and on.
+    void     powerCycle();
+    // Replaces a fault that is still pending.
+    void     injectFault(Fault fault, uint32_t frames, uint8_t byteIndex = 3, uint8_t bit = 0);
+    bool     faultPending() const;
+
+    void pinChanged(uint8_t pin, bool level) override;
+
+private: // methods
+    void    beginFrame();
+    void    endFrame();
+    void    clockFalling();
+    void    clockRising();
+    uint8_t responseByte(uint8_t index) const;
+    uint8_t pollByte(uint8_t index) const;
+    uint8_t frameSize() const;
+    void    faultFrameDone();
+
+private: // data
+    uint8_t  clockPin_;
+    uint8_t  commandPin_;
+    uint8_t  attentionPin_;
+    uint8_t  dataPin_;
+    uint8_t  typeId_             = 0x03;
+    uint8_t  modeEntries_        = 2;
+    uint8_t  actuatorEntries_    = 2;
+    bool     connected_          = true;
+    bool     selected_           = false;
+    bool     config_             = false;
+    bool     analog_             = false;
+    bool     pressures_          = false;
+    bool     rumbleMapped_       = false;
+    uint8_t  byteIndex_          = 0;
+    uint8_t  bitIndex_           = 0;
+    uint8_t  commandByte_        = 0;
+    uint8_t  response_           = 0xFF;
+    uint8_t  command_[maxFrameSize];
+    uint16_t buttons_            = 0;
+    uint8_t  sticks_[4]          = { 0x80, 0x80, 0x80, 0x80 };
+    uint8_t  pressureValues_[12] = {};
+    uint8_t  smallMotor_         = 0;
+    uint8_t  largeMotor_         = 0;
+    uint32_t frames_             = 0;
+    Fault    fault_              = Fault::None;
+    uint32_t faultFrames_        = 0;
+    uint8_t  faultByte_          = 0;
+    uint8_t  faultBit_           = 0;
+};
+
+} // namespace sim
+
+#endif // SIM_PAD_HPP
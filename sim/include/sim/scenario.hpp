@@ -0,0 +1,22 @@
+#ifndef SIM_SCENARIO_HPP
+#define SIM_SCENARIO_HPP
+
+#include "sim/bus.hpp"
+
+#include "ps2.hpp"
+#include "ps2_latency.hpp"
+
+namespace sim {
+
+// Same wiring as src/main.cpp.
+inline constexpr BusPins defaultPins = { 13, 11, 10, 12 };
+
+// Puts simulated time, pins and SREG statistics back to power-on state.
+void resetSimulation();
+bool parseInterruptPolicy(const char *name, ps2::InterruptPolicy &policy);
+void printLatencyHeader();
+void printLatency(const char *stage, const ps2::LatencyHistogram &histogram);
+
+} // namespace sim
+
+#endif // SIM_SCENARIO_HPP
@@ -0,0 +1,74 @@
+#ifndef SIM_TRACE_HPP
+#define SIM_TRACE_HPP
+
+#include "sim/bus.hpp"
+
+#include <string>
+#include <vector>
+
+namespace sim {
+
+struct Transition
+{
+    uint64_t timeNs;
+    uint8_t  pin;
+    bool     level;
+};
+
+// Records every level change of the named pins with its simulated timestamp.
+class Trace : public Device
+{
+public:
+    Trace();
+    ~Trace() override;
+
+    void                           addSignal(uint8_t pin, const char *name);
+    const std::vector<Transition> &transitions() const;
+    bool                           writeVcd(const char *path) const;
+    void                           clear();
+
+    void pinChanged(uint8_t pin, bool level) override;
+
+private: // types
+    struct Signal
+    {
+        uint8_t     pin;
+        std::string name;
+        bool        initialLevel;
+    };
+
+private: // data
+    std::vector<Signal>     signals_;
+    std::vector<Transition> transitions_;
+    uint64_t                startNs_;
+};
+
+// Timing the pad needs to see, all in nanoseconds.
+struct ProtocolLimits
+{
+    uint64_t minClockLowNs       = 2000;
+    uint64_t minClockHighNs      = 250;
+    uint64_t minSetupNs          = 500;  // CMD stable before the rising CLK edge.
+    uint64_t minHoldNs           = 100;  // CMD stable after the rising CLK edge.
+    uint64_t minAttentionSetupNs = 2000; // ATT low until the first falling CLK edge.
+    uint64_t minByteGapNs        = 2000; // Last rising CLK edge of a byte until the first falling edge of the next.
+    uint64_t maxByteGapNs        = 1000000;
+    uint64_t minFrameGapNs       = 10000; // ATT high until ATT low again.
+
+    bool set(const char *name, uint64_t value);
+};
+
+struct Violation
+{
+    const char *rule;
+    uint64_t    timeNs;
+    uint64_t    measured;
+    uint64_t    limit;
+    const char *unit;
+};
+
+std::vector<Violation> checkProtocol(const Trace &trace, const BusPins &pins, const ProtocolLimits &limits);
+
+} // namespace sim
+
+#endif // SIM_TRACE_HPP
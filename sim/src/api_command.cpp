@@ -0,0 +1,162 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <new>
+
+namespace sim {
+
+namespace {
+
+struct ApiCase
+{
+    const char *name;
+    bool (*run)();
+};
+
+// Configures a pad on the default pins, prints the error when that fails.
+bool configurePad(ps2::Controller &controller, bool pressures, bool rumble)
+{
+    const BusPins       &pins  = defaultPins;
+    const ps2::ErrorCode error = controller.configure(pins.clock, pins.command, pins.attention, pins.data, pressures,
+                                                      rumble);
+    if (error != ps2::ErrorCode::Success) {
+        printf("  configure failed with error %d\n", static_cast<int>(error));
+        return false;
+    }
+    return true;
+}
+
+// Pressures switched on after configure() must not turn the new 0x79 frames into wrong-mode dropouts.
+bool enablePressuresAfterConfigure()
+{
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    if (!configurePad(controller, false, false)) {
+        return false;
+    }
+    const bool enabled = controller.enablePressures();
+    pad.press(PSB_CROSS, 0xC0);
+    uint16_t held = 0;
+    for (uint16_t i = 0; i < 20; ++i) {
+        delay(16);
+        controller.readData();
+        held += (controller.buttonPressed(PSB_CROSS) ? 1 : 0);
+    }
+    const ps2::LinkStats stats = controller.linkStats();
+    printf("  enablePressures() %d, pad mode 0x%02X, CROSS held in %u of 20 polls, %u frames dropped\n", enabled,
+           static_cast<int>(pad.mode()), static_cast<unsigned>(held), static_cast<unsigned>(stats.droppedFrames));
+    return (enabled == ps2::config::pressures && held == 20 && stats.droppedFrames == 0
+            && (!ps2::config::pressures || controller.analogButtonState(PSAB_CROSS) == 0xC0));
+}
+
+// Threshold setters given an id outside their channel range, e.g. a stick id or a PSB_* mask, must not write
+// anything. The controller sits in front of guard bytes that would catch a write past its end.
+bool thresholdIdsOutOfRange()
+{
+    constexpr size_t guardSize = 512;
+    alignas(ps2::Controller) unsigned char storage[sizeof(ps2::Controller) + guardSize];
+    memset(storage, 0xA5, sizeof(storage));
+    ps2::Controller &controller = *new (storage) ps2::Controller {};
+    controller.setPressureThresholds(40, 120, 8);
+    unsigned char before[sizeof(storage)];
+    memcpy(before, storage, sizeof(storage));
+
+    const uint16_t notPressures[] = { PSS_LX, PSAB_PAD_RIGHT - 1, PSAB_R2 + 1, PSB_CROSS, 0xFFFF };
+    for (const uint16_t buttonId : notPressures) {
+        controller.setPressureThresholds(buttonId, 1, 2, 0);
+    }
+    const uint16_t notAnalog[] = { PSS_RX - 1, PSAB_R2 + 1, PSB_CROSS, 0xFFFF };
+    for (const uint16_t buttonId : notAnalog) {
+        controller.setAnalogThreshold(buttonId, 1);
+    }
+    const bool unchanged = (memcmp(before, storage, sizeof(storage)) == 0);
+    controller.setPressureThresholds(PSAB_CROSS, 1, 2, 0);
+    const bool inRangeWritten = (!ps2::config::pressures || memcmp(before, storage, sizeof(storage)) != 0);
+    printf("  out-of-range ids left the controller %s, an in-range id %s\n", (unchanged ? "unchanged" : "CHANGED"),
+           (inRangeWritten ? "was applied" : "was NOT applied"));
+    controller.~Controller();
+    return (unchanged && inRangeWritten);
+}
+
+// The status reply announces the mode table in byte 4 and the actuator table in byte 6. A DualShock 2 reports 2 for
+// both, so a pad with one motor entry and two modes tells them apart.
+bool statusTableSizes()
+{
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    pad.setTableSizes(2, 1);
+    if (!configurePad(controller, false, false)) {
+        return false;
+    }
+    const ps2::Capabilities capabilities = controller.capabilities();
+    printf("  2 modes and 1 actuator announced: %u modes, %u actuators, digital %d, analog %d\n",
+           static_cast<unsigned>(capabilities.modes), static_cast<unsigned>(capabilities.actuators),
+           capabilities.digital, capabilities.analog);
+    return (capabilities.discovered && capabilities.modes == 2 && capabilities.actuators == 1 && capabilities.digital
+            && capabilities.analog);
+}
+
+// configure() again, e.g. after a reconnect, starts change detection over: a threshold set before is back to the
+// default, so a small stick move is reported.
+bool reconfigureResetsAnalogChanges()
+{
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    if (!configurePad(controller, false, false)) {
+        return false;
+    }
+    controller.setAnalogThreshold(PSS_LX, 100);
+    delay(16);
+    controller.readData();
+    if (!configurePad(controller, false, false)) {
+        return false;
+    }
+    pad.setStick(PSS_LX, 0x90);
+    delay(16);
+    controller.readData();
+    const bool reported = controller.analogStateChanged(PSS_LX);
+    printf("  stick moved by 0x10 after configure() again: %s\n", (reported ? "reported" : "NOT reported"));
+    return reported;
+}
+
+const ApiCase cases[] = {
+    { "enable-pressures", enablePressuresAfterConfigure },
+    { "threshold-range", thresholdIdsOutOfRange },
+    { "status-table-sizes", statusTableSizes },
+    { "reconfigure-analog", reconfigureResetsAnalogChanges },
+};
+
+} // namespace
+
+// Small regression cases of the Controller API against the simulated pad. Exits with 2 when any case fails.
+int apiCommand(int argc, char *argv[])
+{
+    const char *only   = optionValue(argc, argv, "--case", nullptr);
+    unsigned    failed = 0;
+    for (const ApiCase &apiCase : cases) {
+        if (only != nullptr && strcmp(only, apiCase.name) != 0) {
+            continue;
+        }
+        printf("%s\n", apiCase.name);
+        const bool passed = apiCase.run();
+        printf("  %s\n", (passed ? "ok" : "FAILED"));
+        failed += (passed ? 0 : 1);
+    }
+    printf("%u failed\n", failed);
+    return (failed == 0 ? 0 : 2);
+}
+
+} // namespace sim
@@ -0,0 +1,239 @@
+#include <Arduino.h>
+
+#include <stdio.h>
+
+sim::StatusRegister SREG;
+HardwareSerial      Serial;
+
+namespace sim {
+
+StatusRegister::operator uint8_t() const
+{
+    return value_;
+}
+
+StatusRegister &StatusRegister::operator=(uint8_t value)
+{
+    const bool wasEnabled = interruptsEnabled();
+    value_                = value;
+    const bool isEnabled  = interruptsEnabled();
+    if (wasEnabled && !isEnabled) {
+        interruptsOffSinceNs_ = clock().nowNs();
+    } else if (!wasEnabled && isEnabled) {
+        const uint64_t offNs = clock().nowNs() - interruptsOffSinceNs_;
+        totalInterruptsOffNs_ += offNs;
+        if (offNs > maxInterruptsOffNs_) {
+            maxInterruptsOffNs_ = offNs;
+        }
+    }
+    return *this;
+}
+
+bool StatusRegister::interruptsEnabled() const
+{
+    return (value_ & (1u << interruptBit));
+}
+
+uint64_t StatusRegister::maxInterruptsOffNs() const
+{
+    return maxInterruptsOffNs_;
+}
+
+uint64_t StatusRegister::totalInterruptsOffNs() const
+{
+    return totalInterruptsOffNs_;
+}
+
+void StatusRegister::resetStatistics()
+{
+    maxInterruptsOffNs_   = 0;
+    totalInterruptsOffNs_ = 0;
+}
+
+} // namespace sim
+
+unsigned long millis()
+{
+    return static_cast<unsigned long>(sim::clock().nowNs() / 1000000);
+}
+
+unsigned long micros()
+{
+    return static_cast<unsigned long>(sim::clock().nowNs() / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    sim::clock().advanceNs(static_cast<uint64_t>(ms) * 1000000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    sim::clock().advanceNs(static_cast<uint64_t>(us) * 1000);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    sim::bus().setPinMode(pin, mode == OUTPUT);
+    if (mode == INPUT_PULLUP) {
+        sim::bus().write(pin, true);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    sim::bus().write(pin, value != LOW);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return (sim::bus().level(pin) ? HIGH : LOW);
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh)
+{
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+    return (pin < sim::Bus::pinCount ? sim::bus().portOf(pin) : NOT_A_PORT);
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+    return sim::bus().bitMaskOf(pin);
+}
+
+sim::Register *portOutputRegister(uint8_t port)
+{
+    return sim::bus().outputRegister(port);
+}
+
+sim::Register *portInputRegister(uint8_t port)
+{
+    return sim::bus().inputRegister(port);
+}
+
+sim::Register *portModeRegister(uint8_t port)
+{
+    return sim::bus().directionRegister(port);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+size_t Print::print(const char text[])
+{
+    return write(reinterpret_cast<const uint8_t *>(text), strlen(text));
+}
+
+size_t Print::print(char value)
+{
+    return write(static_cast<uint8_t>(value));
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char  buffer[8 * sizeof(value) + 1];
+    char *digit = buffer + sizeof(buffer) - 1;
+    *digit      = '\0';
+    do {
+        const unsigned long remainder = value % base;
+        *--digit                      = static_cast<char>(remainder < 10 ? '0' + remainder : 'A' + remainder - 10);
+        value /= base;
+    } while (value > 0);
+    return print(digit);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (value < 0 && base == DEC) {
+        return print('-') + print(static_cast<unsigned long>(-value), base);
+    }
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print(static_cast<long>(value), base);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::println()
+{
+    return print("\n");
+}
+
+size_t Print::println(const char text[])
+{
+    return print(text) + println();
+}
+
+size_t Print::println(char value)
+{
+    return print(value) + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned char value, int base)
+{
+    return print(value, base) + println();
+}
+
+void HardwareSerial::begin(unsigned long)
+{
+}
+
+int HardwareSerial::available()
+{
+    return 0;
+}
+
+int HardwareSerial::read()
+{
+    return -1;
+}
+
+int HardwareSerial::peek()
+{
+    return -1;
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    return (putchar(value) == EOF ? 0 : 1);
+}
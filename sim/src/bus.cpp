@@ -0,0 +1,263 @@
+#include "sim/bus.hpp"
+
+#include <algorithm>
+
+namespace sim {
+
+namespace {
+
+// Arduino port numbers, see pins_arduino.h.
+constexpr uint8_t portB = 2;
+constexpr uint8_t portC = 3;
+constexpr uint8_t portD = 4;
+
+} // namespace
+
+uint64_t Clock::nowNs() const
+{
+    return nowNs_;
+}
+
+void Clock::advanceNs(uint64_t ns)
+{
+    const uint64_t targetNs = nowNs_ + ns;
+    while (!events_.empty() && events_.begin()->first <= targetNs) {
+        const std::function<void()> event = events_.begin()->second;
+        nowNs_                            = std::max(nowNs_, events_.begin()->first);
+        events_.erase(events_.begin());
+        event();
+    }
+    nowNs_ = targetNs;
+}
+
+void Clock::schedule(uint64_t timeNs, std::function<void()> event)
+{
+    events_.emplace(timeNs, std::move(event));
+}
+
+void Clock::reset()
+{
+    nowNs_ = 0;
+    events_.clear();
+}
+
+Register::Register(uint8_t port, Kind kind) : port_ { port }, kind_ { kind }
+{
+}
+
+Register::operator uint8_t() const
+{
+    return bus().readPort(port_, kind_);
+}
+
+Register &Register::operator=(uint8_t value)
+{
+    bus().writePort(port_, kind_, value);
+    return *this;
+}
+
+Register &Register::operator|=(uint8_t value)
+{
+    return (*this = static_cast<uint8_t>(*this | value));
+}
+
+Register &Register::operator&=(uint8_t value)
+{
+    return (*this = static_cast<uint8_t>(*this & value));
+}
+
+Register &Register::operator^=(uint8_t value)
+{
+    return (*this = static_cast<uint8_t>(*this ^ value));
+}
+
+Bus::Bus()
+{
+    for (uint8_t port = 0; port < portCount; ++port) {
+        outputRegisters_.emplace_back(port, Register::Kind::Output);
+        inputRegisters_.emplace_back(port, Register::Kind::Input);
+        directionRegisters_.emplace_back(port, Register::Kind::Direction);
+    }
+}
+
+Register *Bus::outputRegister(uint8_t port)
+{
+    return &outputRegisters_[port];
+}
+
+Register *Bus::inputRegister(uint8_t port)
+{
+    return &inputRegisters_[port];
+}
+
+Register *Bus::directionRegister(uint8_t port)
+{
+    return &directionRegisters_[port];
+}
+
+uint8_t Bus::portOf(uint8_t pin) const
+{
+    if (pin < 8) {
+        return portD;
+    }
+    return (pin < 14 ? portB : portC);
+}
+
+uint8_t Bus::bitMaskOf(uint8_t pin) const
+{
+    return static_cast<uint8_t>(1u << (pin - firstPinOf(portOf(pin))));
+}
+
+// A read-modify-write through a Register is charged as one read and one write.
+uint8_t Bus::readPort(uint8_t port, Register::Kind kind)
+{
+    clock().advanceNs(registerCostNs_);
+    uint8_t value = 0;
+    for (uint8_t bit = 0; bit < pinsOf(port); ++bit) {
+        const Pin &pin   = pins_[firstPinOf(port) + bit];
+        bool       isSet = false;
+        switch (kind) {
+            case Register::Kind::Output: isSet = pin.latch; break;
+            case Register::Kind::Input: isSet = level(firstPinOf(port) + bit); break;
+            case Register::Kind::Direction: isSet = pin.output; break;
+        }
+        if (isSet) {
+            value |= static_cast<uint8_t>(1u << bit);
+        }
+    }
+    return value;
+}
+
+void Bus::writePort(uint8_t port, Register::Kind kind, uint8_t value)
+{
+    if (kind == Register::Kind::Input) {
+        return;
+    }
+    bool oldLevels[8];
+    for (uint8_t bit = 0; bit < pinsOf(port); ++bit) {
+        const uint8_t pinNumber = firstPinOf(port) + bit;
+        oldLevels[bit]          = level(pinNumber);
+        Pin &pin                = pins_[pinNumber];
+        if (kind == Register::Kind::Output) {
+            pin.latch = (value & (1u << bit));
+        } else {
+            pin.output = (value & (1u << bit));
+        }
+    }
+    for (uint8_t bit = 0; bit < pinsOf(port); ++bit) {
+        notify(firstPinOf(port) + bit, oldLevels[bit]);
+    }
+}
+
+void Bus::setPinMode(uint8_t pin, bool output)
+{
+    const bool oldLevel = level(pin);
+    pins_[pin].output   = output;
+    notify(pin, oldLevel);
+}
+
+void Bus::write(uint8_t pin, bool level)
+{
+    const bool oldLevel = this->level(pin);
+    pins_[pin].latch    = level;
+    notify(pin, oldLevel);
+}
+
+// Inputs without a driver read as their pull-up, which is enabled by the output latch as on AVR. A floating input
+// reads high, like the open-collector PS2 data line.
+bool Bus::level(uint8_t pin) const
+{
+    const Pin &state = pins_[pin];
+    if (state.output) {
+        return state.latch;
+    }
+    if (state.driven) {
+        return state.drivenLevel;
+    }
+    return true;
+}
+
+void Bus::drive(uint8_t pin, bool level)
+{
+    const bool oldLevel    = this->level(pin);
+    pins_[pin].driven      = true;
+    pins_[pin].drivenLevel = level;
+    notify(pin, oldLevel);
+}
+
+void Bus::release(uint8_t pin)
+{
+    const bool oldLevel = level(pin);
+    pins_[pin].driven   = false;
+    notify(pin, oldLevel);
+}
+
+void Bus::attach(Device &device)
+{
+    devices_.push_back(&device);
+}
+
+void Bus::detach(Device &device)
+{
+    devices_.erase(std::remove(devices_.begin(), devices_.end(), &device), devices_.end());
+}
+
+void Bus::setRegisterCostNs(uint64_t ns)
+{
+    registerCostNs_ = ns;
+}
+
+void Bus::reset()
+{
+    for (Pin &pin : pins_) {
+        pin = Pin {};
+    }
+    devices_.clear();
+    registerCostNs_ = defaultRegisterCostNs;
+}
+
+uint8_t Bus::firstPinOf(uint8_t port) const
+{
+    switch (port) {
+        case portB: return 8;
+        case portC: return 14;
+        default: return 0;
+    }
+}
+
+uint8_t Bus::pinsOf(uint8_t port) const
+{
+    switch (port) {
+        case portB: return 6;
+        case portC: return 6;
+        case portD: return 8;
+        default: return 0;
+    }
+}
+
+void Bus::notify(uint8_t pin, bool oldLevel)
+{
+    const bool newLevel = level(pin);
+    if (newLevel == oldLevel) {
+        return;
+    }
+    // Devices may attach or drive pins while being notified.
+    const std::vector<Device *> devices = devices_;
+    for (Device *device : devices) {
+        device->pinChanged(pin, newLevel);
+    }
+}
+
+Clock &clock()
+{
+    static Clock instance;
+    return instance;
+}
+
+Bus &bus()
+{
+    static Bus instance;
+    return instance;
+}
+
+} // namespace sim
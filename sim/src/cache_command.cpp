@@ -0,0 +1,99 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_cache.hpp"
+
+#include <stdio.h>
+
+namespace sim {
+
+namespace {
+
+struct Reader
+{
+    const char *name;
+    uint64_t    maxAgeMs;
+    uint64_t    maxSeenAgeUs;
+};
+
+struct Result
+{
+    uint32_t polls;
+    uint64_t loopNs;
+    uint64_t maxLoopNs;
+};
+
+void printResult(const char *policy, const Result &result, uint64_t loops)
+{
+    printf("%-8s %7u %12.1f %12.1f\n", policy, static_cast<unsigned>(result.polls), result.loopNs / 1000.0 / loops,
+           result.maxLoopNs / 1000.0);
+}
+
+} // namespace
+
+// Three modules read the pad in every loop iteration, each with its own max age. Without the cache every read is a
+// bus transaction, with it only the reads that find the frame too old are.
+int cacheCommand(int argc, char *argv[])
+{
+    const uint64_t loops     = optionNumber(argc, argv, "--loops", 2000);
+    const uint64_t workUs    = optionNumber(argc, argv, "--work-us", 1000);
+    const uint64_t driveMs   = optionNumber(argc, argv, "--drive-ms", 5);
+    const uint64_t uiMs      = optionNumber(argc, argv, "--ui-ms", 20);
+    const uint64_t telemetry = optionNumber(argc, argv, "--telemetry-ms", 50);
+
+    Reader   readers[] = { { "drive", driveMs, 0 }, { "ui", uiMs, 0 }, { "telemetry", telemetry, 0 } };
+    Result   results[2] {};
+    uint32_t hits      = 0;
+    uint32_t misses    = 0;
+    for (int cached = 0; cached < 2; ++cached) {
+        resetSimulation();
+        const BusPins  &pins = defaultPins;
+        Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+        ps2::Controller controller {};
+        if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, false, false)
+            != ps2::ErrorCode::Success) {
+            fprintf(stderr, "configure failed\n");
+            return 1;
+        }
+        ps2::FrameCache cache(controller);
+        const uint32_t  framesBefore = pad.frames();
+        Result         &result       = results[cached];
+        for (uint64_t loop = 0; loop < loops; ++loop) {
+            const uint64_t loopStartNs = clock().nowNs();
+            for (Reader &reader : readers) {
+                if (cached) {
+                    cache.read(reader.maxAgeMs);
+                } else {
+                    controller.readData();
+                }
+                const uint64_t ageUs = micros() - controller.frameCompletedUs();
+                reader.maxSeenAgeUs  = (cached && ageUs > reader.maxSeenAgeUs ? ageUs : reader.maxSeenAgeUs);
+                delayMicroseconds(workUs / 3);
+            }
+            const uint64_t loopNs = clock().nowNs() - loopStartNs;
+            result.loopNs += loopNs;
+            result.maxLoopNs = (loopNs > result.maxLoopNs ? loopNs : result.maxLoopNs);
+        }
+        result.polls = pad.frames() - framesBefore;
+        hits         = cache.hits();
+        misses       = cache.misses();
+    }
+
+    printf("%llu loops, 3 readers, %llu us of work per loop\n", (unsigned long long)loops, (unsigned long long)workUs);
+    printf("%-8s %7s %12s %12s\n", "policy", "polls", "avg loop us", "max loop us");
+    printResult("direct", results[0], loops);
+    printResult("cached", results[1], loops);
+    printf("cache hits %u, misses %u\n", static_cast<unsigned>(hits), static_cast<unsigned>(misses));
+    bool tooOld = false;
+    for (const Reader &reader : readers) {
+        printf("%-10s max age %3llu ms, oldest frame seen %6.2f ms\n", reader.name,
+               (unsigned long long)reader.maxAgeMs, reader.maxSeenAgeUs / 1000.0);
+        tooOld |= (reader.maxSeenAgeUs >= reader.maxAgeMs * 1000);
+    }
+    return (tooOld ? 2 : 0);
+}
+
+} // namespace sim
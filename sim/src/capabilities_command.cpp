@@ -0,0 +1,81 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+
+#include <stdio.h>
+
+namespace sim {
+
+namespace {
+
+constexpr uint64_t pollGapUs = 4000;
+
+struct Request
+{
+    const char *name;
+    uint8_t     needs;
+};
+
+constexpr Request requests[] = {
+    { "buttons", ps2::needs::buttons },
+    { "buttons+rumble", ps2::needs::buttons | ps2::needs::rumble },
+    { "sticks", ps2::needs::sticks },
+    { "sticks+rumble", ps2::needs::sticks | ps2::needs::rumble },
+    { "pressures", ps2::needs::pressures },
+    { "pressures+rumble", ps2::needs::pressures | ps2::needs::rumble },
+};
+
+} // namespace
+
+// Configures the pad once per set of needs, reports what discovery found, the frame it chose and the bus time of a
+// poll, and checks that buttons, sticks and motors still arrive.
+int capabilitiesCommand(int argc, char *argv[])
+{
+    const uint64_t polls  = optionNumber(argc, argv, "--polls", 200);
+    bool           failed = false;
+    printf("%-17s %5s %5s %6s %13s %12s %7s %6s\n", "needs", "error", "mode", "bytes", "configure ms", "us per poll",
+           "button", "motor");
+    for (const Request &request : requests) {
+        resetSimulation();
+        const BusPins  &pins = defaultPins;
+        Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+        ps2::Controller controller {};
+        const uint64_t  configureNs = clock().nowNs();
+        const ps2::ErrorCode error
+            = controller.configure(pins.clock, pins.command, pins.attention, pins.data, request.needs);
+        const double configureMs = (clock().nowNs() - configureNs) / 1e6;
+
+        pad.press(PSB_CROSS);
+        pad.setStick(PSS_LX, 0x20);
+        const uint64_t startedNs = clock().nowNs();
+        for (uint64_t i = 0; i < polls; ++i) {
+            controller.readData(true, 0x80);
+            delayMicroseconds(pollGapUs);
+        }
+        const double pollUs     = (clock().nowNs() - startedNs - polls * pollGapUs * 1000) / 1000.0 / polls;
+        const bool   button     = controller.buttonPressed(PSB_CROSS);
+        const bool   stick      = (controller.analogButtonState(PSS_LX) == 0x20);
+        const bool   sticksOk   = (!(request.needs & (ps2::needs::sticks | ps2::needs::pressures)) || stick);
+        const bool   motor      = (pad.smallMotor() != 0);
+        const bool   motorOk    = (!(request.needs & ps2::needs::rumble) || motor);
+        failed |= (error != ps2::ErrorCode::Success || !button || !sticksOk || !motorOk);
+        printf("%-17s %5d  0x%02X %6u %13.1f %12.1f %7s %6s\n", request.name, static_cast<int>(error),
+               static_cast<int>(pad.mode()), static_cast<unsigned>(controller.frameBytes()), configureMs, pollUs,
+               (button ? "ok" : "lost"), (motor ? "on" : "off"));
+
+        if (&request == &requests[0]) {
+            const ps2::Capabilities capabilities = controller.capabilities();
+            printf("  discovered %s: type 0x%02X, %u actuators, %u modes (digital %s, analog %s), pressures %s\n",
+                   (capabilities.discovered ? "yes" : "no"), static_cast<int>(capabilities.typeId),
+                   static_cast<unsigned>(capabilities.actuators), static_cast<unsigned>(capabilities.modes),
+                   (capabilities.digital ? "yes" : "no"), (capabilities.analog ? "yes" : "no"),
+                   (capabilities.pressures ? "yes" : "no"));
+        }
+    }
+    return (failed ? 2 : 0);
+}
+
+} // namespace sim
@@ -0,0 +1,251 @@
+#include "sim/capture.hpp"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sim {
+
+namespace {
+
+constexpr char    captureMagic[6]    = { 'P', 'S', '2', 'C', 'A', 'P' };
+constexpr uint8_t fullFrameSize      = 21;
+constexpr uint8_t firstAnalogByte    = 5;
+constexpr uint8_t analogChannelCount = 16;
+constexpr size_t  blockFrames        = 16;
+
+uint16_t pressedButtons(const CaptureRecord &record)
+{
+    return static_cast<uint16_t>(~(record.frame[3] | (record.frame[4] << 8)));
+}
+
+// Fields that don't depend on the kernel: timestamps, mode bytes and buttons.
+void decodeScalarFields(const CaptureRecord *records, size_t first, size_t count, FrameColumns &columns)
+{
+    uint16_t previous = pressedButtons(records[first > 0 ? first - 1 : first]);
+    for (size_t i = first; i < first + count; ++i) {
+        const uint16_t buttons     = pressedButtons(records[i]);
+        columns.timestampUs[i]    = records[i].timestampUs;
+        columns.mode[i]           = records[i].frame[1];
+        columns.buttons[i]        = buttons;
+        columns.changedButtons[i] = buttons ^ previous;
+        previous                  = buttons;
+    }
+}
+
+void decodeAnalogScalar(const CaptureRecord *records, size_t first, size_t count, FrameColumns &columns)
+{
+    const uint8_t *previous = records[first > 0 ? first - 1 : first].frame + firstAnalogByte;
+    for (size_t i = first; i < first + count; ++i) {
+        const uint8_t *values  = records[i].frame + firstAnalogByte;
+        uint16_t       changes = 0;
+        for (uint8_t channel = 0; channel < analogChannelCount; ++channel) {
+            columns.analog[channel][i] = values[channel];
+            changes |= static_cast<uint16_t>((values[channel] != previous[channel]) << channel);
+        }
+        columns.analogChanges[i] = changes;
+        previous                 = values;
+    }
+}
+
+#if defined(__SSE2__)
+// Sixteen frames at a time: their 16 analog bytes form a 16x16 byte matrix that four rounds of interleaving rows i and
+// i + 8 transpose into one vector per channel. Change masks come from comparing each row with the one before it.
+void decodeAnalogSse2(const CaptureRecord *records, size_t first, size_t count, FrameColumns &columns)
+{
+    const size_t blocks = count / blockFrames;
+    __m128i      previous
+        = _mm_loadu_si128(reinterpret_cast<const __m128i *>(records[first > 0 ? first - 1 : first].frame + firstAnalogByte));
+    for (size_t block = 0; block < blocks; ++block) {
+        const size_t base = first + block * blockFrames;
+        __m128i      rows[blockFrames];
+        for (size_t k = 0; k < blockFrames; ++k) {
+            rows[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(records[base + k].frame + firstAnalogByte));
+            const int equal              = _mm_movemask_epi8(_mm_cmpeq_epi8(rows[k], previous));
+            columns.analogChanges[base + k] = static_cast<uint16_t>(~equal);
+            previous                     = rows[k];
+        }
+        for (int round = 0; round < 4; ++round) {
+            __m128i interleaved[blockFrames];
+            for (size_t k = 0; k < blockFrames / 2; ++k) {
+                interleaved[2 * k]     = _mm_unpacklo_epi8(rows[k], rows[k + 8]);
+                interleaved[2 * k + 1] = _mm_unpackhi_epi8(rows[k], rows[k + 8]);
+            }
+            memcpy(rows, interleaved, sizeof(rows));
+        }
+        for (uint8_t channel = 0; channel < analogChannelCount; ++channel) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(columns.analog[channel].data() + base), rows[channel]);
+        }
+    }
+    const size_t done = blocks * blockFrames;
+    if (done < count) {
+        decodeAnalogScalar(records, first + done, count - done, columns);
+    }
+}
+#endif
+
+} // namespace
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open(const char *path)
+{
+    close();
+    file_ = fopen(path, "wb");
+    if (!file_) {
+        return false;
+    }
+    CaptureHeader header {};
+    memcpy(header.magic, captureMagic, sizeof(header.magic));
+    header.version    = captureVersion;
+    header.recordSize = sizeof(CaptureRecord);
+    return (fwrite(&header, sizeof(header), 1, file_) == 1);
+}
+
+bool CaptureWriter::add(uint32_t timestampUs, const uint8_t *frame, uint8_t size)
+{
+    CaptureRecord record {};
+    record.timestampUs = timestampUs;
+    record.size        = (size < fullFrameSize ? size : fullFrameSize);
+    memcpy(record.frame, frame, record.size);
+    return (file_ && fwrite(&record, sizeof(record), 1, file_) == 1);
+}
+
+bool CaptureWriter::close()
+{
+    if (!file_) {
+        return true;
+    }
+    const bool closed = (fclose(file_) == 0);
+    file_             = nullptr;
+    return closed;
+}
+
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+bool CaptureFile::open(const char *path)
+{
+    close();
+    const int descriptor = ::open(path, O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(CaptureHeader)) {
+        ::close(descriptor);
+        return false;
+    }
+    size_              = static_cast<size_t>(status.st_size);
+    void *const mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (mapped == MAP_FAILED) {
+        size_ = 0;
+        return false;
+    }
+    mapping_                     = mapped;
+    const CaptureHeader &header = *static_cast<const CaptureHeader *>(mapping_);
+    if (memcmp(header.magic, captureMagic, sizeof(captureMagic)) != 0 || header.version != captureVersion
+        || header.recordSize != sizeof(CaptureRecord)) {
+        close();
+        return false;
+    }
+    madvise(mapping_, size_, MADV_SEQUENTIAL);
+    frames_ = (size_ - sizeof(CaptureHeader)) / sizeof(CaptureRecord);
+    return true;
+}
+
+void CaptureFile::close()
+{
+    if (mapping_) {
+        munmap(mapping_, size_);
+    }
+    mapping_ = nullptr;
+    size_    = 0;
+    frames_  = 0;
+}
+
+size_t CaptureFile::frames() const
+{
+    return frames_;
+}
+
+const CaptureRecord *CaptureFile::records() const
+{
+    return reinterpret_cast<const CaptureRecord *>(static_cast<const uint8_t *>(mapping_) + sizeof(CaptureHeader));
+}
+
+void FrameColumns::resize(size_t frames)
+{
+    timestampUs.resize(frames);
+    mode.resize(frames);
+    buttons.resize(frames);
+    changedButtons.resize(frames);
+    analogChanges.resize(frames);
+    for (std::vector<uint8_t> &channel : analog) {
+        channel.resize(frames);
+    }
+}
+
+bool kernelAvailable(DecodeKernel kernel)
+{
+#if defined(__SSE2__)
+    return (kernel == DecodeKernel::Scalar || kernel == DecodeKernel::Sse2);
+#else
+    return (kernel == DecodeKernel::Scalar);
+#endif
+}
+
+void decodeFrames(const CaptureFile &file, size_t first, size_t count, FrameColumns &columns, DecodeKernel kernel)
+{
+    if (count == 0) {
+        return;
+    }
+    const CaptureRecord *records = file.records();
+    decodeScalarFields(records, first, count, columns);
+#if defined(__SSE2__)
+    if (kernel == DecodeKernel::Sse2) {
+        decodeAnalogSse2(records, first, count, columns);
+        return;
+    }
+#else
+    (void)kernel;
+#endif
+    decodeAnalogScalar(records, first, count, columns);
+}
+
+void decodeParallel(const CaptureFile &file, FrameColumns &columns, unsigned threads, DecodeKernel kernel)
+{
+    // Chunks are whole SSE2 blocks, so only the last one has a scalar tail, and there are never more threads than
+    // blocks: a capture shorter than the thread count would otherwise get empty chunks.
+    const size_t frames = file.frames();
+    const size_t blocks = (frames + blockFrames - 1) / blockFrames;
+    threads             = (threads == 0 ? 1 : threads);
+    threads             = static_cast<unsigned>(blocks > 0 && blocks < threads ? blocks : threads);
+    const size_t chunk  = ((blocks + threads - 1) / threads) * blockFrames;
+    std::vector<std::thread> workers;
+    for (size_t first = 0; first < frames; first += chunk) {
+        const size_t count = (frames - first < chunk ? frames - first : chunk);
+        workers.emplace_back([&file, &columns, first, count, kernel] {
+            decodeFrames(file, first, count, columns, kernel);
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,179 @@
+#include "sim/capture.hpp"
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace sim {
+
+namespace {
+
+constexpr uint16_t tappedButtons[]  = { PSB_CROSS, PSB_CIRCLE, PSB_SQUARE, PSB_PAD_UP, PSB_L1, PSB_R2 };
+constexpr uint8_t  stickIds[]       = { PSS_RX, PSS_RY, PSS_LX, PSS_LY };
+constexpr uint8_t  stickCenter      = 0x80;
+constexpr uint8_t  maxFrameSize     = 21;
+constexpr int      smoothingDivisor = 8;
+
+// A stick axis eases toward a target that moves every few hundred milliseconds, with a little sensor noise on top.
+struct StickAxis
+{
+    int value  = stickCenter << 8;
+    int target = stickCenter << 8;
+};
+
+struct Measurement
+{
+    const char  *name;
+    DecodeKernel kernel;
+    unsigned     threads;
+};
+
+bool sameColumns(const FrameColumns &a, const FrameColumns &b)
+{
+    bool same = (a.timestampUs == b.timestampUs && a.mode == b.mode && a.buttons == b.buttons
+                 && a.changedButtons == b.changedButtons && a.analogChanges == b.analogChanges);
+    for (size_t channel = 0; channel < 16; ++channel) {
+        same = same && (a.analog[channel] == b.analog[channel]);
+    }
+    return same;
+}
+
+double bestDecodeSeconds(const CaptureFile &file, FrameColumns &columns, const Measurement &measurement, uint64_t rounds)
+{
+    double best = 0;
+    for (uint64_t round = 0; round < rounds; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        decodeParallel(file, columns, measurement.threads, measurement.kernel);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best                 = (round == 0 || seconds < best ? seconds : best);
+    }
+    return best;
+}
+
+} // namespace
+
+// Polls a pad whose sticks wander and whose buttons are tapped now and then, and writes every frame to a capture file.
+int recordCommand(int argc, char *argv[])
+{
+    const char    *path      = optionValue(argc, argv, "--out", "ps2.cap");
+    const uint64_t frames    = optionNumber(argc, argv, "--frames", 100000);
+    const uint64_t pollUs    = optionNumber(argc, argv, "--poll-us", 4000);
+    const bool     pressures = optionFlag(argc, argv, "--pressures");
+    std::mt19937   random(static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1)));
+
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, pressures, false)
+        != ps2::ErrorCode::Success) {
+        fprintf(stderr, "configure failed\n");
+        return 1;
+    }
+    CaptureWriter writer;
+    if (!writer.open(path)) {
+        fprintf(stderr, "Can't write %s\n", path);
+        return 1;
+    }
+
+    std::uniform_int_distribution<int> targetValue(0x00, 0xFF << 8);
+    std::uniform_int_distribution<int> targetPolls(50, 200);
+    std::uniform_int_distribution<int> noise(-1, 1);
+    std::uniform_int_distribution<int> tapPolls(5, 60);
+    std::uniform_int_distribution<int> tappedButton(0, sizeof(tappedButtons) / sizeof(tappedButtons[0]) - 1);
+    StickAxis                          axes[4];
+    int                                nextTarget = 0;
+    int                                nextTap    = tapPolls(random);
+    uint16_t                           held       = 0;
+    uint8_t                            frame[maxFrameSize];
+    for (uint64_t poll = 0; poll < frames; ++poll) {
+        if (--nextTarget <= 0) {
+            axes[random() % 4].target = targetValue(random);
+            nextTarget                = targetPolls(random) / 4;
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            axes[i].value += (axes[i].target - axes[i].value) / smoothingDivisor;
+            const int value = (axes[i].value >> 8) + noise(random);
+            pad.setStick(stickIds[i], static_cast<uint8_t>(value < 0 ? 0 : (value > 0xFF ? 0xFF : value)));
+        }
+        if (--nextTap <= 0) {
+            const uint16_t button = tappedButtons[tappedButton(random)];
+            if (held & button) {
+                pad.release(button);
+            } else {
+                pad.press(button, static_cast<uint8_t>(0x40 + random() % 0xC0));
+            }
+            held ^= button;
+            nextTap = tapPolls(random);
+        }
+
+        controller.readData();
+        const uint8_t size = (controller.analogButtonState(1) == 0x79 ? maxFrameSize : 9);
+        for (uint8_t i = 0; i < size; ++i) {
+            frame[i] = controller.analogButtonState(i);
+        }
+        writer.add(static_cast<uint32_t>(controller.frameCompletedUs()), frame, size);
+        delayMicroseconds(pollUs);
+    }
+    if (!writer.close()) {
+        fprintf(stderr, "Can't write %s\n", path);
+        return 1;
+    }
+    printf("%llu frames of mode 0x%02X written to %s\n", (unsigned long long)frames,
+           static_cast<int>(controller.analogButtonState(1)), path);
+    return 0;
+}
+
+// Decodes a memory-mapped capture into columns with the scalar and SSE2 kernels, single-threaded and over all cores.
+int decodeCommand(int argc, char *argv[])
+{
+    const char    *path    = optionValue(argc, argv, "--in", "ps2.cap");
+    const uint64_t rounds  = optionNumber(argc, argv, "--rounds", 10);
+    unsigned       threads = static_cast<unsigned>(optionNumber(argc, argv, "--threads", 0));
+    threads                = (threads == 0 ? std::thread::hardware_concurrency() : threads);
+    threads                = (threads == 0 ? 1 : threads);
+
+    CaptureFile file;
+    if (!file.open(path)) {
+        fprintf(stderr, "Can't map %s or it is not a capture file\n", path);
+        return 1;
+    }
+    FrameColumns reference;
+    FrameColumns columns;
+    reference.resize(file.frames());
+    columns.resize(file.frames());
+    decodeFrames(file, 0, file.frames(), reference, DecodeKernel::Scalar);
+
+    const Measurement measurements[] = {
+        { "scalar", DecodeKernel::Scalar, 1 },
+        { "sse2", DecodeKernel::Sse2, 1 },
+        { "scalar", DecodeKernel::Scalar, threads },
+        { "sse2", DecodeKernel::Sse2, threads },
+    };
+    printf("%zu frames, %zu MB, best of %llu rounds\n", file.frames(),
+           file.frames() * sizeof(CaptureRecord) / 1000000, (unsigned long long)rounds);
+    printf("%-8s %8s %14s %10s\n", "kernel", "threads", "frames/s", "ns/frame");
+    bool matches = true;
+    for (const Measurement &measurement : measurements) {
+        if (!kernelAvailable(measurement.kernel)) {
+            printf("%-8s %8u %14s\n", measurement.name, measurement.threads, "not built");
+            continue;
+        }
+        const double seconds = bestDecodeSeconds(file, columns, measurement, rounds);
+        const bool   same    = sameColumns(reference, columns);
+        matches              = matches && same;
+        printf("%-8s %8u %14.0f %10.2f%s\n", measurement.name, measurement.threads, file.frames() / seconds,
+               seconds * 1e9 / file.frames(), (same ? "" : "  MISMATCH"));
+    }
+    return (matches ? 0 : 2);
+}
+
+} // namespace sim
@@ -0,0 +1,190 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2_coprocessor.hpp"
+#include "ps2_coprocessor_wire.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <deque>
+#include <functional>
+
+namespace sim {
+
+namespace {
+
+constexpr uint16_t tapButton   = PSB_CROSS;
+constexpr uint16_t heldButton  = PSB_R1;
+constexpr uint8_t  motorLevel  = 0xC0;
+constexpr uint64_t idleStepNs  = 100000;
+constexpr uint64_t uartIdleNs  = 10000;
+constexpr uint8_t  uartBits    = 10; // Start, 8 data and stop bit.
+
+// One end of a UART connection. Written bytes arrive at the peer after their transmission time, the peer's receive
+// hook stands in for its loop() servicing the port.
+class SerialEnd : public Stream
+{
+public:
+    explicit SerialEnd(uint64_t baudRate) : byteNs_ { uartBits * 1000000000ull / baudRate } {}
+
+    void connect(SerialEnd &peer) { peer_ = &peer; }
+    void onReceive(std::function<void()> hook) { receiveHook_ = std::move(hook); }
+
+    size_t write(uint8_t value) override
+    {
+        clock().advanceNs(byteNs_);
+        peer_->received_.push_back(value);
+        if (peer_->receiveHook_) {
+            peer_->receiveHook_();
+        }
+        return 1;
+    }
+    using Print::write;
+
+    int available() override
+    {
+        if (received_.empty()) {
+            clock().advanceNs(uartIdleNs);
+        }
+        return static_cast<int>(received_.size());
+    }
+
+    int read() override
+    {
+        if (received_.empty()) {
+            return -1;
+        }
+        const uint8_t value = received_.front();
+        received_.pop_front();
+        return value;
+    }
+
+    int peek() override { return (received_.empty() ? -1 : received_.front()); }
+
+private: // data
+    uint64_t              byteNs_;
+    SerialEnd            *peer_ = nullptr;
+    std::deque<uint8_t>   received_;
+    std::function<void()> receiveHook_;
+};
+
+} // namespace
+
+// A coprocessor polls the pad while a main controller reads the register map over I2C or UART at its own rate. Short
+// taps of a button fall between two reads and must still show up in the change register, a held button must never
+// drop out, and the rumble config written by the main controller must reach the pad.
+int coprocessorCommand(int argc, char *argv[])
+{
+    const char    *link       = optionValue(argc, argv, "--link", "i2c");
+    const uint64_t durationMs = optionNumber(argc, argv, "--ms", 2000);
+    const uint64_t pollMs     = optionNumber(argc, argv, "--poll-ms", 4);
+    const uint64_t readMs     = optionNumber(argc, argv, "--read-ms", 20);
+    const uint64_t tapMs      = optionNumber(argc, argv, "--tap-ms", 2 * pollMs);
+    const uint64_t tapEveryMs = optionNumber(argc, argv, "--tap-every-ms", 53);
+    const uint64_t i2cHz      = optionNumber(argc, argv, "--i2c-hz", 400000);
+    const uint64_t baudRate   = optionNumber(argc, argv, "--baud", 115200);
+    const bool     uart       = (strcmp(link, "uart") == 0);
+    if (!uart && strcmp(link, "i2c") != 0) {
+        fprintf(stderr, "Unknown link %s\n", link);
+        return 1;
+    }
+
+    resetSimulation();
+    const BusPins   &pins = defaultPins;
+    Pad              pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Coprocessor coprocessor;
+    if (coprocessor.begin(pins.clock, pins.command, pins.attention, pins.data, true, true) != ps2::ErrorCode::Success) {
+        fprintf(stderr, "configure failed\n");
+        return 1;
+    }
+
+    ps2::SerialRegisterPort serialPort;
+    SerialEnd               mainEnd(baudRate);
+    SerialEnd               coprocessorEnd(baudRate);
+    ps2::StreamLink         streamLink(mainEnd);
+    ps2::WireLink           wireLink;
+    if (uart) {
+        mainEnd.connect(coprocessorEnd);
+        coprocessorEnd.connect(mainEnd);
+        coprocessorEnd.onReceive([&] { serialPort.service(coprocessorEnd, coprocessor.registers()); });
+    } else {
+        ps2::beginWireSlave(coprocessor.registers());
+        Wire.setClock(static_cast<uint32_t>(i2cHz));
+    }
+    ps2::CoprocessorClient client(uart ? static_cast<ps2::CoprocessorLink &>(streamLink) : wireLink);
+    if (!client.probe() || !client.setPollPeriod(static_cast<uint8_t>(pollMs))
+        || !client.setMotors(true, motorLevel)) {
+        fprintf(stderr, "coprocessor not answering over %s\n", link);
+        return 1;
+    }
+
+    // Taps and the held button are scheduled so they land anywhere between two reads.
+    uint64_t tapStartedNs = 0;
+    uint32_t taps         = 0;
+    uint32_t tapsSeen     = 0;
+    bool     tapPending   = false;
+    for (uint64_t atMs = tapEveryMs; atMs + tapMs < durationMs; atMs += tapEveryMs) {
+        clock().schedule(clock().nowNs() + atMs * 1000000, [&] {
+            ++taps;
+            tapPending   = true;
+            tapStartedNs = clock().nowNs();
+            pad.press(tapButton);
+        });
+        clock().schedule(clock().nowNs() + (atMs + tapMs) * 1000000, [&] { pad.release(tapButton); });
+    }
+    pad.press(heldButton);
+
+    ps2::LatencyHistogram transfer;
+    ps2::LatencyHistogram tapLatency;
+    ps2::Snapshot         snapshot {};
+    transfer.setBucketWidth(100);
+    tapLatency.setBucketWidth(static_cast<uint16_t>(readMs * 1000 / 16));
+    const uint64_t        endNs        = clock().nowNs() + durationMs * 1000000;
+    uint64_t              nextReadNs   = clock().nowNs() + readMs * 1000000;
+    uint32_t              reads        = 0;
+    uint32_t              failedReads  = 0;
+    uint32_t              heldDropped  = 0;
+    uint32_t              pollsPerRead = 0;
+    uint8_t               lastSequence = 0;
+    while (clock().nowNs() < endNs) {
+        coprocessor.poll();
+        if (clock().nowNs() < nextReadNs) {
+            clock().advanceNs(idleStepNs);
+            continue;
+        }
+        nextReadNs += readMs * 1000000;
+        const uint64_t startedNs = clock().nowNs();
+        if (!client.readSnapshot(snapshot)) {
+            ++failedReads;
+            continue;
+        }
+        transfer.add(static_cast<unsigned long>((clock().nowNs() - startedNs) / 1000));
+        if (reads++ > 0) {
+            pollsPerRead += static_cast<uint8_t>(snapshot.sequence - lastSequence);
+        }
+        lastSequence = snapshot.sequence;
+        heldDropped += ((snapshot.buttons & heldButton) ? 0 : 1);
+        if (tapPending && ((snapshot.buttons | snapshot.changedButtons) & tapButton)) {
+            tapPending = false;
+            ++tapsSeen;
+            tapLatency.add(static_cast<unsigned long>((clock().nowNs() - tapStartedNs) / 1000));
+        }
+    }
+
+    printf("%s link: %u reads, %u failed, %.1f polls per read, pad mode 0x%02X, status 0x%02X\n", link,
+           static_cast<unsigned>(reads), static_cast<unsigned>(failedReads),
+           reads > 1 ? static_cast<double>(pollsPerRead) / (reads - 1) : 0.0, static_cast<int>(pad.mode()),
+           static_cast<int>(snapshot.status) | (snapshot.configured ? ps2::registers::configured : 0));
+    printf("taps %u, seen %u, held button dropped %u times, motors small %u large 0x%02X\n",
+           static_cast<unsigned>(taps), static_cast<unsigned>(tapsSeen), static_cast<unsigned>(heldDropped),
+           static_cast<unsigned>(pad.smallMotor()), static_cast<unsigned>(pad.largeMotor()));
+    printLatencyHeader();
+    printLatency("transfer", transfer);
+    printLatency("tap", tapLatency);
+    return (failedReads == 0 && tapsSeen == taps && heldDropped == 0 && pad.largeMotor() != 0 ? 0 : 2);
+}
+
+} // namespace sim
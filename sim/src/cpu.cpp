@@ -0,0 +1,107 @@
+#include "sim/bus.hpp"
+#include "sim/cpu.hpp"
+
+#include <avr/io.h>
+#include <avr/sleep.h>
+
+namespace sim {
+
+namespace {
+
+constexpr uint64_t ticksPerOverflow = 256;
+
+} // namespace
+
+uint8_t Timer0::counter() const
+{
+    return static_cast<uint8_t>(clock().nowNs() / tickNs);
+}
+
+uint8_t &Timer0::compareB()
+{
+    return compareB_;
+}
+
+uint8_t &Timer0::interruptMask()
+{
+    return interruptMask_;
+}
+
+// Writing a one clears a flag on the chip, the simulator never sets them.
+uint8_t &Timer0::interruptFlags()
+{
+    return interruptFlags_;
+}
+
+// Compare B matches when the counter steps to OCR0B, the overflow when it steps from 255 to 0.
+uint64_t Timer0::nextInterruptNs(bool &compareMatch) const
+{
+    const uint64_t tick       = clock().nowNs() / tickNs;
+    const uint64_t overflow   = (tick / ticksPerOverflow + 1) * ticksPerOverflow;
+    const uint8_t  ahead      = static_cast<uint8_t>(compareB_ - static_cast<uint8_t>(tick));
+    const uint64_t match      = tick + (ahead == 0 ? ticksPerOverflow : ahead);
+    const bool     compareOn  = (interruptMask_ & (1u << compareBEnable));
+    const bool     overflowOn = (interruptMask_ & (1u << overflowEnable));
+    compareMatch              = (compareOn && (!overflowOn || match < overflow));
+    return (compareMatch ? match : overflow) * tickNs;
+}
+
+void Timer0::reset()
+{
+    compareB_       = 0;
+    interruptMask_  = (1u << overflowEnable);
+    interruptFlags_ = 0;
+}
+
+void SleepController::setMode(uint8_t mode)
+{
+    mode_ = mode;
+}
+
+void SleepController::setEnabled(bool enabled)
+{
+    enabled_ = enabled;
+}
+
+void SleepController::sleep()
+{
+    if (!enabled_) {
+        return; // SLEEP is a no-op without the sleep enable bit.
+    }
+    bool           compareMatch = false;
+    const uint64_t wakeNs       = timer0().nextInterruptNs(compareMatch);
+    const uint64_t startNs      = clock().nowNs();
+    if (mode_ != SLEEP_MODE_IDLE || !SREG.interruptsEnabled()) {
+        ++stats_.lockups;
+    }
+    ++stats_.sleeps;
+    stats_.compareWakeups += compareMatch;
+    stats_.sleptNs += wakeNs - startNs;
+    clock().advanceNs(wakeNs - startNs);
+}
+
+const SleepController::Stats &SleepController::stats() const
+{
+    return stats_;
+}
+
+void SleepController::reset()
+{
+    mode_    = 0;
+    enabled_ = false;
+    stats_   = {};
+}
+
+Timer0 &timer0()
+{
+    static Timer0 instance;
+    return instance;
+}
+
+SleepController &sleepController()
+{
+    static SleepController instance;
+    return instance;
+}
+
+} // namespace sim
@@ -0,0 +1,137 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace sim {
+
+namespace {
+
+constexpr uint16_t heldButton        = PSB_R1;
+constexpr uint8_t  expectedMode      = static_cast<uint8_t>(Pad::Mode::Analog);
+constexpr uint64_t pollMs            = 16;
+constexpr uint64_t recoveryLimitMs   = 5000;
+constexpr uint64_t reconfigurationMs = 1600;
+
+struct FaultCase
+{
+    const char *name;
+    Pad::Fault  fault;
+    uint32_t    frames;
+    uint8_t     byteIndex;
+    uint8_t     bit;
+};
+
+// Byte 4 bit 3 is R1, the held button. A missing ack from byte 3 on reads as all buttons released.
+constexpr FaultCase faultCases[] = {
+    { "bitflip", Pad::Fault::BitFlip, 1, 4, 3 },
+    { "missing-ack", Pad::Fault::MissingAck, 3, 3, 0 },
+    { "slow-config-exit", Pad::Fault::SlowConfigExit, 3, 0, 0 },
+    { "unplug", Pad::Fault::Unplug, 30, 5, 0 },
+    { "receiver-0xff", Pad::Fault::ReceiverIdle, 10, 0, 0 },
+};
+
+enum class Path : uint8_t
+{
+    ReadData,
+    SetControllerMode,
+    ReconfigureController
+};
+
+constexpr const char *pathNames[] = { "readData", "setControllerMode", "reconfigureController" };
+
+struct Outcome
+{
+    bool           recovered;
+    uint64_t       recoveryUs;  // Injection until the first Valid frame that matches the pad.
+    uint32_t       wrongFrames; // Valid frames whose buttons differ from the pad.
+    uint32_t       heldLost;    // Frames that reported the held button as released.
+    ps2::ErrorCode error;
+};
+
+bool matchesPad(const ps2::Controller &controller, const Pad &pad)
+{
+    return (controller.frameStatus() == ps2::FrameStatus::Valid && controller.pressedButtons() == pad.buttons()
+            && controller.analogButtonState(1) == expectedMode);
+}
+
+// Injects the fault where the path under test talks to the pad and polls until the controller reports the pad
+// correctly again. configure() errors are not retried, like a sketch that configures once in setup().
+Outcome runCase(const FaultCase &faultCase, Path path)
+{
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    Outcome         outcome { false, 0, 0, 0, ps2::ErrorCode::Success };
+    pad.press(heldButton);
+
+    uint64_t injectedNs = 0;
+    if (path == Path::SetControllerMode) {
+        pad.injectFault(faultCase.fault, faultCase.frames, faultCase.byteIndex, faultCase.bit);
+        injectedNs    = clock().nowNs();
+        outcome.error = controller.configure(pins.clock, pins.command, pins.attention, pins.data, false, false);
+    } else {
+        outcome.error = controller.configure(pins.clock, pins.command, pins.attention, pins.data, false, false);
+        for (int i = 0; i < 10; ++i) {
+            controller.readData();
+            delay(pollMs);
+        }
+        if (path == Path::ReconfigureController) {
+            delay(reconfigurationMs);
+        }
+        pad.injectFault(faultCase.fault, faultCase.frames, faultCase.byteIndex, faultCase.bit);
+        injectedNs = clock().nowNs();
+    }
+
+    const uint64_t limitNs = injectedNs + recoveryLimitMs * 1000000;
+    while (clock().nowNs() < limitNs) {
+        controller.readData();
+        const bool valid = (controller.frameStatus() == ps2::FrameStatus::Valid);
+        outcome.wrongFrames += (valid && controller.pressedButtons() != pad.buttons() ? 1 : 0);
+        outcome.heldLost += (controller.buttonPressed(heldButton) ? 0 : 1);
+        // A slow config exit only bites when the library leaves config mode, polling alone never triggers it.
+        const bool faultOver = (!pad.faultPending() || faultCase.fault == Pad::Fault::SlowConfigExit);
+        if (faultOver && matchesPad(controller, pad)) {
+            outcome.recovered  = true;
+            outcome.recoveryUs = (clock().nowNs() - injectedNs) / 1000;
+            break;
+        }
+        delay(pollMs);
+    }
+    return outcome;
+}
+
+} // namespace
+
+// Every fault class against the three places the library talks to the pad: polling in readData(), configure() with
+// setControllerMode(), and the reconfigureController() that readData() does after a long pause.
+int faultsCommand(int argc, char *argv[])
+{
+    const char *only = optionValue(argc, argv, "--fault", nullptr);
+
+    printf("%-17s %-22s %6s %12s %6s %9s\n", "fault", "path", "error", "recovered ms", "wrong", "held lost");
+    for (const FaultCase &faultCase : faultCases) {
+        if (only && strcmp(only, faultCase.name) != 0) {
+            continue;
+        }
+        for (uint8_t path = 0; path < 3; ++path) {
+            const Outcome outcome = runCase(faultCase, static_cast<Path>(path));
+            printf("%-17s %-22s %6d ", faultCase.name, pathNames[path], static_cast<int>(outcome.error));
+            if (outcome.recovered) {
+                printf("%12.1f", outcome.recoveryUs / 1000.0);
+            } else {
+                printf("%12s", "never");
+            }
+            printf(" %6u %9u\n", static_cast<unsigned>(outcome.wrongFrames), static_cast<unsigned>(outcome.heldLost));
+        }
+    }
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,75 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <random>
+
+namespace sim {
+
+namespace {
+
+const char *onOff(bool enabled)
+{
+    return (enabled ? "on" : "off");
+}
+
+} // namespace
+
+// Reports what the compiled-in feature set costs per poll: the bus time of readData() in simulated time and the host
+// CPU time of decoding a frame. Build the simulator with different PS2_* feature macros, see ps2_config.hpp, and
+// compare, e.g. [env:native] against [env:native_buttons].
+int featuresCommand(int argc, char *argv[])
+{
+    const uint64_t polls   = optionNumber(argc, argv, "--polls", 1000);
+    const uint64_t decodes = optionNumber(argc, argv, "--decodes", 2000000);
+    std::mt19937   random(static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1)));
+
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    const ps2::ErrorCode error
+        = controller.configure(pins.clock, pins.command, pins.attention, pins.data, true, true);
+    printf("pressures %s, rumble %s, reconfiguration %s, guitar hero %s\n", onOff(ps2::config::pressures),
+           onOff(ps2::config::rumble), onOff(ps2::config::reconfiguration), onOff(ps2::config::guitarHero));
+    printf("configure(pressures, rumble): error %d, pad mode 0x%02X, sizeof(Controller) %zu bytes\n",
+           static_cast<int>(error), static_cast<int>(pad.mode()), sizeof(ps2::Controller));
+
+    const uint64_t startedNs = clock().nowNs();
+    for (uint64_t i = 0; i < polls; ++i) {
+        pad.setStick(PSS_LX, static_cast<uint8_t>(random()));
+        controller.readData(true, 0x80);
+        delay(4);
+    }
+    const double readUs = (clock().nowNs() - startedNs - polls * 4000000) / 1000.0 / polls;
+
+    // Frames as the pad sends them in pressure mode, the decoder only looks at what its feature set keeps.
+    byte frames[16][21];
+    for (auto &frame : frames) {
+        frame[0] = 0xFF;
+        frame[1] = 0x79;
+        frame[2] = 0x5A;
+        for (uint8_t i = 3; i < sizeof(frame); ++i) {
+            frame[i] = static_cast<byte>(random());
+        }
+    }
+    const auto decodeStarted = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < decodes; ++i) {
+        controller.decodeFrame(frames[i % 16], sizeof(frames[0]), 0);
+    }
+    const double decodeNs
+        = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - decodeStarted).count() / decodes;
+
+    printf("readData: %.1f us bus time per poll (simulated)\n", readUs);
+    printf("decode:   %.1f ns per frame (host CPU), pressure mask 0x%03X\n", decodeNs,
+           static_cast<unsigned>(controller.pressureMask()));
+    return (error == ps2::ErrorCode::Success ? 0 : 2);
+}
+
+} // namespace sim
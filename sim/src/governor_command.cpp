@@ -0,0 +1,181 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_governor.hpp"
+#include "ps2_latency.hpp"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+constexpr uint16_t burstButtons[] = { PSB_CROSS, PSB_CIRCLE, PSB_PAD_LEFT, PSB_R2 };
+constexpr uint64_t idleStepNs     = 100000;
+constexpr uint64_t settleNs       = 1000000000;
+
+struct ScriptedChange
+{
+    uint64_t timeNs;
+    uint16_t button; // 0 for a stick move.
+    bool     press;
+    uint8_t  stick;
+};
+
+struct PolicyResult
+{
+    ps2::LatencyProbe probe;
+    uint32_t          polls    = 0;
+    uint64_t          busyNs   = 0;
+    uint64_t          maxGapNs = 0;
+};
+
+// Idle spells of a few seconds alternate with bursts of button taps and stick moves.
+std::vector<ScriptedChange> makeScript(uint64_t durationMs, std::mt19937 &random)
+{
+    std::uniform_int_distribution<uint64_t> idleNs(2000000000ull, 6000000000ull);
+    std::uniform_int_distribution<uint64_t> gapNs(60000000ull, 250000000ull);
+    std::uniform_int_distribution<int>      burstSize(2, 5);
+    std::uniform_int_distribution<int>      stickValue(0x20, 0xE0);
+    std::vector<ScriptedChange>             script;
+    const uint64_t                          endNs  = settleNs + durationMs * 1000000;
+    uint64_t                                timeNs = settleNs;
+    while (true) {
+        timeNs += idleNs(random);
+        const int taps = burstSize(random);
+        for (int i = 0; i < taps && timeNs < endNs; ++i) {
+            const uint16_t button = burstButtons[i % (sizeof(burstButtons) / sizeof(burstButtons[0]))];
+            script.push_back({ timeNs, button, true, 0 });
+            timeNs += gapNs(random);
+            script.push_back({ timeNs, button, false, 0 });
+            timeNs += gapNs(random);
+            script.push_back({ timeNs, 0, false, static_cast<uint8_t>(stickValue(random)) });
+            timeNs += gapNs(random);
+        }
+        if (timeNs >= endNs) {
+            return script;
+        }
+    }
+}
+
+// Polls either every fixedMs or whenever the governor says so, and measures change to frame latency of the button
+// changes together with the time spent on the bus.
+bool runPolicy(const std::vector<ScriptedChange> &script, uint64_t durationMs, uint64_t fixedMs,
+               ps2::PollGovernor *governor, PolicyResult &result)
+{
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, false, false)
+        != ps2::ErrorCode::Success) {
+        return false;
+    }
+    controller.setAnalogThreshold(4);
+
+    std::deque<uint64_t> changeTimesNs;
+    for (const ScriptedChange &change : script) {
+        clock().schedule(change.timeNs, [&pad, change] {
+            if (change.button == 0) {
+                pad.setStick(PSS_LX, change.stick);
+            } else if (change.press) {
+                pad.press(change.button);
+            } else {
+                pad.release(change.button);
+            }
+        });
+        if (change.button != 0) {
+            changeTimesNs.push_back(change.timeNs);
+        }
+    }
+
+    result.probe.setBucketWidth(1000);
+    const uint64_t endNs      = settleNs + durationMs * 1000000;
+    uint64_t       lastPollNs = clock().nowNs();
+    while (clock().nowNs() < endNs) {
+        const uint64_t nowNs = clock().nowNs();
+        const bool     due   = (governor ? governor->due() : nowNs - lastPollNs >= fixedMs * 1000000);
+        if (!due) {
+            clock().advanceNs(idleStepNs);
+            continue;
+        }
+        result.maxGapNs = (nowNs - lastPollNs > result.maxGapNs ? nowNs - lastPollNs : result.maxGapNs);
+        lastPollNs      = nowNs;
+        controller.readData();
+        result.busyNs += clock().nowNs() - nowNs;
+        ++result.polls;
+        result.probe.frameRead(controller);
+        if (governor) {
+            governor->update(controller);
+        }
+        if (controller.buttonsStateChanged()) {
+            const uint64_t frameCompletedNs = static_cast<uint64_t>(controller.frameCompletedUs()) * 1000;
+            uint64_t       changeNs         = 0;
+            bool           found            = false;
+            while (!changeTimesNs.empty() && changeTimesNs.front() <= frameCompletedNs) {
+                changeNs = (found ? changeNs : changeTimesNs.front());
+                found    = true;
+                changeTimesNs.pop_front();
+            }
+            if (found) {
+                result.probe.consumed(micros(), static_cast<unsigned long>(changeNs / 1000));
+            }
+        }
+    }
+    return true;
+}
+
+void printPolicy(const char *name, const PolicyResult &result, uint64_t durationMs)
+{
+    printf("%-10s %7u %10.1f %8.3f %10.1f\n", name, static_cast<unsigned>(result.polls), result.busyNs / 1e6,
+           100.0 * result.busyNs / (durationMs * 1e6), result.maxGapNs / 1e6);
+}
+
+} // namespace
+
+// The same script of idle spells and bursts under a fixed poll rate and under PollGovernor, reports bus time and the
+// latency of button changes for both.
+int governorCommand(int argc, char *argv[])
+{
+    const uint64_t durationMs = optionNumber(argc, argv, "--ms", 60000);
+    const uint64_t activeMs   = optionNumber(argc, argv, "--active-ms", 4);
+    const uint64_t idleMs
+        = std::min<uint64_t>(optionNumber(argc, argv, "--idle-ms", 100), ps2::PollGovernor::maxIdlePeriodMs);
+    const uint64_t quietMs    = optionNumber(argc, argv, "--quiet-ms", 500);
+    std::mt19937   random(static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1)));
+
+    const std::vector<ScriptedChange> script = makeScript(durationMs, random);
+    ps2::PollGovernor                 governor;
+    governor.setPeriods(static_cast<uint16_t>(activeMs), static_cast<uint16_t>(idleMs));
+    governor.setQuietTime(static_cast<uint16_t>(quietMs));
+
+    PolicyResult fixed;
+    PolicyResult governed;
+    if (!runPolicy(script, durationMs, activeMs, nullptr, fixed)
+        || !runPolicy(script, durationMs, activeMs, &governor, governed)) {
+        fprintf(stderr, "configure failed\n");
+        return 1;
+    }
+
+    printf("%zu scripted changes over %llu ms, active %llu ms, idle %llu ms, quiet %llu ms\n", script.size(),
+           (unsigned long long)durationMs, (unsigned long long)activeMs, (unsigned long long)idleMs,
+           (unsigned long long)quietMs);
+    printf("%-10s %7s %10s %8s %10s\n", "policy", "polls", "bus ms", "bus %", "max gap ms");
+    printPolicy("fixed", fixed, durationMs);
+    printPolicy("governor", governed, durationMs);
+    printLatencyHeader();
+    printLatency("fixed", fixed.probe.total());
+    printLatency("governor", governed.probe.total());
+    const bool reconfigured = (governed.maxGapNs / 1000000 > ps2::Controller::readPeriodUntilReconfiguration);
+    return (reconfigured ? 2 : 0);
+}
+
+} // namespace sim
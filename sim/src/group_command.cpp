@@ -0,0 +1,116 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_group.hpp"
+#include "ps2_lockstep.hpp"
+
+#include <stdio.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+// Same wiring as `ps2sim lockstep`, so the pads can be polled either way.
+constexpr uint8_t  dataPins[]   = { 12, 8, 9 };
+constexpr uint8_t  maxPads      = sizeof(dataPins) / sizeof(dataPins[0]);
+constexpr uint64_t pollPeriodNs = 4000000;
+constexpr uint8_t  markerStick  = PSS_LX - PSS_RX;
+
+struct Reads
+{
+    uint64_t accessors = 0; // Per-controller reads that mixed two batches.
+    uint64_t snapshot  = 0; // GroupSnapshot reads that did.
+};
+
+} // namespace
+
+// Every batch writes its number into the left stick X of all pads. Readers fire at random times, as interrupts would,
+// and check that all pads show the same batch: once through the per-controller accessors, once through the group's
+// snapshot, whose batch number must also match its sequence. Runs with one readData() per controller and with a
+// LockstepGroup feeding publish().
+int groupCommand(int argc, char *argv[])
+{
+    const uint64_t padCount = optionNumber(argc, argv, "--pads", maxPads);
+    const uint64_t polls    = optionNumber(argc, argv, "--polls", 1000);
+    const uint64_t reads    = optionNumber(argc, argv, "--reads", 20000);
+    std::mt19937   random(static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1)));
+    if (padCount == 0 || padCount > maxPads) {
+        fprintf(stderr, "--pads must be 1..%u\n", static_cast<unsigned>(maxPads));
+        return 1;
+    }
+
+    printf("%u pads, %llu polls, %llu reads, %zu-byte snapshot\n", static_cast<unsigned>(padCount),
+           (unsigned long long)polls, (unsigned long long)reads, sizeof(ps2::GroupSnapshot));
+    printf("%-9s %9s %15s %15s\n", "batch", "span us", "torn accessors", "torn snapshots");
+    uint64_t failures = 0;
+    for (int lockstep = 0; lockstep < 2; ++lockstep) {
+        resetSimulation();
+        const BusPins                    &pins = defaultPins;
+        std::vector<std::unique_ptr<Pad>> pads;
+        std::vector<ps2::Controller>      controllers(padCount);
+        ps2::ControllerGroup              group;
+        ps2::LockstepGroup                lockstepGroup;
+        for (uint64_t i = 0; i < padCount; ++i) {
+            pads.push_back(std::make_unique<Pad>(pins.clock, pins.command, pins.attention, dataPins[i]));
+        }
+        for (uint64_t i = 0; i < padCount; ++i) {
+            if (controllers[i].configure(pins.clock, pins.command, pins.attention, dataPins[i], ps2::needs::sticks)
+                    != ps2::ErrorCode::Success
+                || !group.add(controllers[i]) || !lockstepGroup.add(controllers[i])) {
+                fprintf(stderr, "pad %u: configure failed\n", static_cast<unsigned>(i));
+                return 1;
+            }
+        }
+
+        Reads                                   torn;
+        const uint64_t                          startNs = clock().nowNs();
+        std::uniform_int_distribution<uint64_t> readNs(startNs, startNs + polls * pollPeriodNs);
+        for (uint64_t i = 0; i < reads; ++i) {
+            clock().schedule(readNs(random), [&] {
+                bool mixed = false;
+                for (uint64_t c = 1; c < padCount; ++c) {
+                    mixed |= (controllers[c].analogButtonState(PSS_LX) != controllers[0].analogButtonState(PSS_LX));
+                }
+                torn.accessors += mixed;
+
+                const ps2::GroupSnapshot &snapshot = group.snapshot();
+                mixed                              = false;
+                for (uint8_t c = 0; c < snapshot.count; ++c) {
+                    mixed |= (snapshot.sticks[markerStick][c] != static_cast<byte>(snapshot.sequence));
+                }
+                torn.snapshot += mixed;
+            });
+        }
+
+        uint64_t spanUs = 0;
+        for (uint64_t poll = 1; poll <= polls; ++poll) {
+            const uint64_t pollStartNs = clock().nowNs();
+            for (const std::unique_ptr<Pad> &pad : pads) {
+                pad->setStick(PSS_LX, static_cast<uint8_t>(poll));
+            }
+            if (lockstep) {
+                lockstepGroup.readData();
+                group.publish();
+            } else {
+                group.poll();
+            }
+            const ps2::GroupSnapshot &snapshot = group.snapshot();
+            spanUs += snapshot.completedUs - snapshot.startedUs;
+            clock().advanceNs(pollPeriodNs - (clock().nowNs() - pollStartNs));
+        }
+
+        printf("%-9s %9.1f %15llu %15llu\n", (lockstep ? "lockstep" : "serial"), static_cast<double>(spanUs) / polls,
+               (unsigned long long)torn.accessors, (unsigned long long)torn.snapshot);
+        failures += torn.snapshot;
+    }
+    return (failures == 0 ? 0 : 2);
+}
+
+} // namespace sim
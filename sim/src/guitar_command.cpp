@@ -0,0 +1,173 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_guitar.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+constexpr uint64_t settleNs    = 100000000;
+constexpr uint64_t fretLeadNs  = 5000000; // Frets go down this long before the strum.
+constexpr uint16_t laneFrets[] = { PSG_GREEN_FRET, PSG_RED_FRET, PSG_YELLOW_FRET, PSG_BLUE_FRET, PSG_ORANGE_FRET };
+
+struct ScriptedStrum
+{
+    uint64_t   timeNs;
+    ps2::Strum direction;
+    uint8_t    lanes;
+    byte       whammy;
+};
+
+struct ErrorStats
+{
+    double sum     = 0;
+    double squares = 0;
+    double maximum = 0;
+
+    void add(double errorUs)
+    {
+        sum += errorUs;
+        squares += errorUs * errorUs;
+        maximum = (fabs(errorUs) > maximum ? fabs(errorUs) : maximum);
+    }
+};
+
+uint16_t fretButtons(uint8_t laneMask)
+{
+    uint16_t buttons = 0;
+    for (uint8_t lane = 0; lane < sizeof(laneFrets) / sizeof(laneFrets[0]); ++lane) {
+        buttons |= ((laneMask >> lane) & 1 ? laneFrets[lane] : 0);
+    }
+    return buttons;
+}
+
+std::vector<uint32_t> parsePeriods(const char *list)
+{
+    std::vector<uint32_t> periods;
+    char                 *end = nullptr;
+    for (const char *next = list; *next; next = (*end == ',' ? end + 1 : end)) {
+        periods.push_back(static_cast<uint32_t>(strtoul(next, &end, 10)));
+        if (end == next) {
+            break;
+        }
+    }
+    return periods;
+}
+
+void printStats(const char *stamp, const ErrorStats &stats, size_t samples)
+{
+    const double mean = stats.sum / samples;
+    printf(" %-8s %9.1f %9.1f %9.1f\n", stamp, mean, sqrt(stats.squares / samples - mean * mean), stats.maximum);
+}
+
+} // namespace
+
+// Scripts strums with random frets and whammy positions at random times and polls a pad through GuitarDecoder at each
+// period, 0 polling back to back. Compares every strum event with the scripted time, once stamped with the midpoint
+// and once with the poll that saw it: mean is the bias, jitter the standard deviation around it.
+int guitarCommand(int argc, char *argv[])
+{
+    const uint64_t              strums   = optionNumber(argc, argv, "--strums", 500);
+    const std::vector<uint32_t> periods  = parsePeriods(optionValue(argc, argv, "--periods-us", "0,2000,4000,8000"));
+    const uint64_t              minGapMs = optionNumber(argc, argv, "--min-gap-ms", 40);
+    const uint64_t              maxGapMs = optionNumber(argc, argv, "--max-gap-ms", 200);
+    const uint32_t              seed     = static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1));
+    if (!ps2::config::guitarHero) {
+        printf("Built with PS2_GUITAR_HERO=0, GuitarDecoder reports nothing\n");
+        return 0;
+    }
+
+    uint64_t failures = 0;
+    printf("%llu strums, 9-byte frames\n", (unsigned long long)strums);
+    printf("%-9s %8s %-8s %9s %9s %9s\n", "period", "poll us", " stamp", "mean us", "jitter", "max |err|");
+    for (uint32_t periodUs : periods) {
+        resetSimulation();
+        const BusPins  &pins = defaultPins;
+        Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+        ps2::Controller controller {};
+        if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, ps2::needs::sticks)
+            != ps2::ErrorCode::Success) {
+            fprintf(stderr, "configure failed\n");
+            return 1;
+        }
+
+        std::mt19937                            random(seed);
+        std::uniform_int_distribution<uint64_t> gapNs(minGapMs * 1000000, maxGapMs * 1000000);
+        std::uniform_int_distribution<uint64_t> holdNs(10000000, 30000000);
+        std::uniform_int_distribution<int>      laneMask(1, 31);
+        std::uniform_int_distribution<int>      whammy(0, 255);
+        std::vector<ScriptedStrum>              script;
+        uint64_t                                timeNs = clock().nowNs() + settleNs;
+        for (uint64_t i = 0; i < strums; ++i) {
+            timeNs += gapNs(random);
+            const ScriptedStrum strum    = { timeNs, (random() & 1 ? ps2::Strum::Up : ps2::Strum::Down),
+                                             static_cast<uint8_t>(laneMask(random)),
+                                             static_cast<byte>(whammy(random)) };
+            const uint16_t      frets    = fretButtons(strum.lanes);
+            const uint16_t      strumBit = (strum.direction == ps2::Strum::Up ? PSG_UP_STRUM : PSG_DOWN_STRUM);
+            const uint64_t      hold     = holdNs(random);
+            clock().schedule(timeNs - fretLeadNs, [&pad, frets, strum] {
+                pad.press(frets);
+                pad.setStick(PSG_WHAMMY_BAR, strum.whammy);
+            });
+            clock().schedule(timeNs, [&pad, strumBit] { pad.press(strumBit); });
+            clock().schedule(timeNs + hold, [&pad, frets, strumBit] { pad.release(frets | strumBit); });
+            script.push_back(strum);
+        }
+        const uint64_t endNs = timeNs + settleNs;
+
+        ps2::GuitarDecoder decoder;
+        ErrorStats         midpoint;
+        ErrorStats         poll;
+        size_t             matched    = 0;
+        uint64_t           mismatches = 0;
+        uint64_t           polls      = 0;
+        const uint64_t     startNs    = clock().nowNs();
+        while (clock().nowNs() < endNs) {
+            const uint64_t loopStartNs = clock().nowNs();
+            controller.readData();
+            decoder.update(controller);
+            ++polls;
+            ps2::StrumEvent event;
+            while (decoder.takeStrum(event) && matched < script.size()) {
+                const ScriptedStrum &strum = script[matched++];
+                mismatches += (event.direction != strum.direction || event.lanes != strum.lanes
+                               || decoder.whammy() != strum.whammy);
+                const double midpointUs = static_cast<double>(event.timestampUs) - strum.timeNs / 1000.0;
+                midpoint.add(midpointUs);
+                poll.add(midpointUs + (event.windowUs - event.windowUs / 2));
+            }
+            const uint64_t elapsedNs = clock().nowNs() - loopStartNs;
+            if (elapsedNs < periodUs * 1000ULL) {
+                clock().advanceNs(periodUs * 1000ULL - elapsedNs);
+            }
+        }
+
+        const uint64_t missed = script.size() - matched + decoder.droppedStrums();
+        failures += missed + mismatches;
+        char period[16];
+        snprintf(period, sizeof(period), (periodUs == 0 ? "b2b" : "%u us"), static_cast<unsigned>(periodUs));
+        printf("%-9s %8.0f", period, static_cast<double>(clock().nowNs() - startNs) / 1000.0 / polls);
+        printStats("midpoint", midpoint, matched);
+        printf("%-18s", "");
+        printStats("poll", poll, matched);
+        if (missed + mismatches > 0) {
+            printf("  %llu strums missed, %llu with wrong direction, lanes or whammy\n", (unsigned long long)missed,
+                   (unsigned long long)mismatches);
+        }
+    }
+    return (failures == 0 ? 0 : 2);
+}
+
+} // namespace sim
@@ -0,0 +1,142 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_history.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+constexpr uint16_t gestureButtons[] = { PSB_CROSS, PSB_CIRCLE, PSB_L1, PSB_PAD_LEFT };
+
+struct Timing
+{
+    std::chrono::nanoseconds history {};
+    std::chrono::nanoseconds scan {};
+};
+
+// Reference answers computed by walking back through every frame recorded so far. Like the history, the stick delta
+// reaches back at most capacity - 1 frames and the tap count stops at tapMemory.
+unsigned long scanHeldMs(const std::vector<ps2::HistorySnapshot> &log, uint16_t button)
+{
+    if (!(log.back().buttons & button)) {
+        return 0;
+    }
+    size_t first = log.size() - 1;
+    while (first > 0 && (log[first - 1].buttons & button)) {
+        --first;
+    }
+    return log.back().timestampMs - log[first].timestampMs;
+}
+
+uint8_t scanTaps(const std::vector<ps2::HistorySnapshot> &log, uint16_t button, unsigned long windowMs)
+{
+    uint8_t taps = 0;
+    for (size_t i = log.size(); i-- > 0 && log.back().timestampMs - log[i].timestampMs < windowMs;) {
+        const bool pressedBefore = (i > 0 && (log[i - 1].buttons & button));
+        taps += ((log[i].buttons & button) && !pressedBefore);
+    }
+    return (taps < ps2::SnapshotHistory::tapMemory ? taps : ps2::SnapshotHistory::tapMemory);
+}
+
+int16_t scanStickDelta(const std::vector<ps2::HistorySnapshot> &log, uint8_t channel, size_t frames)
+{
+    size_t back = (frames < log.size() ? frames : log.size() - 1);
+    back        = (back < ps2::SnapshotHistory::capacity ? back : ps2::SnapshotHistory::capacity - 1);
+    return static_cast<int16_t>(log.back().sticks[channel] - log[log.size() - 1 - back].sticks[channel]);
+}
+
+} // namespace
+
+// Random taps, holds and stick flicks polled with a SnapshotHistory attached. After every frame the hold time, tap
+// count and stick delta queries are checked against a scan over the full frame log, and both are timed.
+int historyCommand(int argc, char *argv[])
+{
+    const uint64_t polls    = optionNumber(argc, argv, "--polls", 5000);
+    const uint64_t pollMs   = optionNumber(argc, argv, "--poll-ms", 16);
+    const uint64_t windowMs = optionNumber(argc, argv, "--window-ms", 300);
+    const uint8_t  frames   = static_cast<uint8_t>(optionNumber(argc, argv, "--frames", 4));
+    std::mt19937   random(static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1)));
+
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, false, false)
+        != ps2::ErrorCode::Success) {
+        fprintf(stderr, "configure failed\n");
+        return 1;
+    }
+    ps2::SnapshotHistory history;
+    controller.attachHistory(&history);
+
+    std::uniform_int_distribution<int> toggle(0, 7);
+    std::uniform_int_distribution<int> stick(0x00, 0xFF);
+    std::vector<ps2::HistorySnapshot>  log;
+    Timing                             timing;
+    uint32_t                           mismatches   = 0;
+    uint32_t                           doubleTaps   = 0;
+    unsigned long                      longestMs    = 0;
+    int16_t                            fastestFlick = 0;
+    for (uint64_t poll = 0; poll < polls; ++poll) {
+        for (uint16_t button : gestureButtons) {
+            if (toggle(random) == 0) {
+                if (pad.buttons() & button) {
+                    pad.release(button);
+                } else {
+                    pad.press(button);
+                }
+            }
+        }
+        if (toggle(random) == 0) {
+            pad.setStick(PSS_LX, static_cast<uint8_t>(stick(random)));
+        }
+        controller.readData();
+
+        ps2::HistorySnapshot snapshot { millis(), controller.pressedButtons(), {} };
+        for (uint8_t i = 0; i < sizeof(snapshot.sticks); ++i) {
+            snapshot.sticks[i] = controller.analogButtonState(PSS_RX + i);
+        }
+        log.push_back(snapshot);
+
+        for (uint16_t button : gestureButtons) {
+            auto                start   = std::chrono::steady_clock::now();
+            const unsigned long heldMs  = history.heldMs(button);
+            const uint8_t       taps    = history.taps(button, windowMs);
+            const int16_t       delta   = history.stickDelta(PSS_LX, frames);
+            auto                scanned = std::chrono::steady_clock::now();
+            mismatches += (heldMs != scanHeldMs(log, button));
+            mismatches += (taps != scanTaps(log, button, windowMs));
+            mismatches += (delta != scanStickDelta(log, PSS_LX - PSS_RX, frames));
+            timing.history += scanned - start;
+            timing.scan += std::chrono::steady_clock::now() - scanned;
+            const bool pressed = (history.snapshot(0).buttons & button) && !(history.snapshot(1).buttons & button);
+            doubleTaps += (pressed && taps >= 2);
+            longestMs    = (heldMs > longestMs ? heldMs : longestMs);
+            fastestFlick = (abs(delta) > fastestFlick ? abs(delta) : fastestFlick);
+        }
+        delay(pollMs);
+    }
+
+    const double queries = static_cast<double>(polls * (sizeof(gestureButtons) / sizeof(gestureButtons[0])));
+    printf("%llu polls every %llu ms, taps within %llu ms, stick delta over %u frames\n", (unsigned long long)polls,
+           (unsigned long long)pollMs, (unsigned long long)windowMs, static_cast<unsigned>(frames));
+    printf("double taps %u, longest hold %lu ms, largest LX delta %d\n", static_cast<unsigned>(doubleTaps), longestMs,
+           static_cast<int>(fastestFlick));
+    printf("history queries %.1f ns, log scan %.1f ns per button and frame\n", timing.history.count() / queries,
+           timing.scan.count() / queries);
+    printf("mismatches against the log scan: %u\n", static_cast<unsigned>(mismatches));
+    return (mismatches == 0 ? 0 : 2);
+}
+
+} // namespace sim
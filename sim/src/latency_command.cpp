@@ -0,0 +1,99 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_latency.hpp"
+
+#include <stdio.h>
+
+#include <deque>
+#include <random>
+
+namespace sim {
+
+namespace {
+
+constexpr uint16_t scriptedButtons[] = { PSB_CROSS, PSB_CIRCLE, PSB_PAD_UP, PSB_L1, PSB_START };
+constexpr uint64_t settleNs          = 1000000000;
+
+} // namespace
+
+// The application loop polls, spends workUs acting on a change and then sleeps for the rest of its period. Button
+// changes are scripted at random times, so they land anywhere in the loop.
+int latencyCommand(int argc, char *argv[])
+{
+    const uint64_t changes   = optionNumber(argc, argv, "--changes", 200);
+    const uint64_t loopUs    = optionNumber(argc, argv, "--loop-us", 16000);
+    const uint64_t workUs    = optionNumber(argc, argv, "--work-us", 200);
+    const uint64_t minGapMs  = optionNumber(argc, argv, "--min-gap-ms", 40);
+    const uint64_t maxGapMs  = optionNumber(argc, argv, "--max-gap-ms", 300);
+    // By default the buckets cover two loop periods, the longest a change can wait is about one.
+    const uint64_t rangeUs   = 2 * (loopUs + workUs);
+    const uint64_t bucketUs  = optionNumber(argc, argv, "--bucket-us",
+                                            (rangeUs + ps2::LatencyHistogram::bucketCount - 1)
+                                                / ps2::LatencyHistogram::bucketCount);
+    const bool     pressures = optionFlag(argc, argv, "--pressures");
+    std::mt19937   random(static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1)));
+
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, pressures, false)
+        != ps2::ErrorCode::Success) {
+        fprintf(stderr, "configure failed\n");
+        return 1;
+    }
+
+    std::deque<uint64_t>                    changeTimesNs;
+    std::uniform_int_distribution<uint64_t> gapNs(minGapMs * 1000000, maxGapMs * 1000000);
+    uint64_t                                timeNs = clock().nowNs() + settleNs;
+    for (uint64_t i = 0; i < changes; ++i) {
+        timeNs += gapNs(random);
+        const uint16_t button = scriptedButtons[(i / 2) % (sizeof(scriptedButtons) / sizeof(scriptedButtons[0]))];
+        const bool     press  = (i % 2 == 0);
+        clock().schedule(timeNs, [&pad, button, press] { press ? pad.press(button) : pad.release(button); });
+        changeTimesNs.push_back(timeNs);
+    }
+    const uint64_t endNs = timeNs + settleNs;
+
+    ps2::LatencyProbe probe;
+    probe.setBucketWidth(static_cast<uint16_t>(bucketUs));
+    uint64_t missed = 0;
+    while (clock().nowNs() < endNs) {
+        const uint64_t loopStartNs = clock().nowNs();
+        controller.readData();
+        probe.frameRead(controller);
+        if (controller.buttonsStateChanged()) {
+            delayMicroseconds(workUs);
+            // All scripted changes up to the end of the frame are in it, only the oldest one is measured.
+            const uint64_t frameCompletedNs = static_cast<uint64_t>(controller.frameCompletedUs()) * 1000;
+            uint64_t       changeNs         = 0;
+            uint64_t       merged           = 0;
+            while (!changeTimesNs.empty() && changeTimesNs.front() <= frameCompletedNs) {
+                changeNs = (merged++ == 0 ? changeTimesNs.front() : changeNs);
+                changeTimesNs.pop_front();
+            }
+            missed += (merged > 1 ? merged - 1 : 0);
+            probe.consumed(micros(), static_cast<unsigned long>(changeNs / 1000));
+        }
+        const uint64_t elapsedNs = clock().nowNs() - loopStartNs;
+        if (elapsedNs < loopUs * 1000) {
+            clock().advanceNs(loopUs * 1000 - elapsedNs);
+        }
+    }
+
+    printf("%llu changes, loop %llu us, work %llu us, %s frames, %llu changes merged into one frame, %llu us buckets\n",
+           (unsigned long long)changes, (unsigned long long)loopUs, (unsigned long long)workUs,
+           pressures ? "21-byte" : "9-byte", (unsigned long long)missed, (unsigned long long)bucketUs);
+    printLatencyHeader();
+    printLatency("poll", probe.poll());
+    printLatency("transaction", probe.transaction());
+    printLatency("pickup", probe.pickup());
+    printLatency("total", probe.total());
+    return 0;
+}
+
+} // namespace sim
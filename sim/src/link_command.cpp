@@ -0,0 +1,100 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+
+#include <stdio.h>
+
+#include <random>
+
+namespace sim {
+
+namespace {
+
+constexpr uint8_t stickNoise     = 2;
+constexpr uint8_t wirelessTypeId = 0x0C;
+
+const char *statusName(ps2::FrameStatus status)
+{
+    switch (status) {
+        case ps2::FrameStatus::Valid: return "valid";
+        case ps2::FrameStatus::Stale: return "stale";
+        case ps2::FrameStatus::Dropout: return "dropout";
+    }
+    return "?";
+}
+
+} // namespace
+
+// Wireless link scenario: sticks carry a little noise like a real pad, then the link repeats frames (stale), drops
+// completely and comes back in the configured mode, and finally comes back after the pad lost its configuration.
+int linkCommand(int argc, char *argv[])
+{
+    const uint64_t pollMs   = optionNumber(argc, argv, "--poll-ms", 16);
+    const uint64_t outageMs = optionNumber(argc, argv, "--outage-ms", 300);
+    const uint64_t staleMs  = optionNumber(argc, argv, "--stale-ms", 800);
+    const uint64_t limit    = optionNumber(argc, argv, "--stale-frames", 30);
+    std::mt19937   random(static_cast<uint32_t>(optionNumber(argc, argv, "--seed", 1)));
+
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    pad.setTypeId(wirelessTypeId);
+    if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, false, false)
+        != ps2::ErrorCode::Success) {
+        fprintf(stderr, "configure failed\n");
+        return 1;
+    }
+    controller.setStaleFrameLimit(static_cast<uint8_t>(limit));
+    pad.press(PSB_R1);
+
+    std::uniform_int_distribution<int> noise(-stickNoise, stickNoise);
+    ps2::FrameStatus                   lastStatus   = controller.frameStatus();
+    unsigned long                      maxHeldAgeMs = 0;
+    bool                               buttonLost   = false;
+    const auto run = [&](const char *phase, uint64_t durationMs, bool noisy) {
+        const uint64_t endNs = clock().nowNs() + durationMs * 1000000;
+        while (clock().nowNs() < endNs) {
+            if (noisy) {
+                pad.setStick(PSS_LX, static_cast<uint8_t>(0x80 + noise(random)));
+            }
+            controller.readData();
+            buttonLost |= !controller.buttonPressed(PSB_R1);
+            if (controller.frameStatus() != ps2::FrameStatus::Valid && controller.frameAgeMs() > maxHeldAgeMs) {
+                maxHeldAgeMs = controller.frameAgeMs();
+            }
+            if (controller.frameStatus() != lastStatus) {
+                printf("%8lu ms  %-22s %s -> %s\n", millis(), phase, statusName(lastStatus),
+                       statusName(controller.frameStatus()));
+                lastStatus = controller.frameStatus();
+            }
+            delay(pollMs);
+        }
+    };
+
+    run("link up", 500, true);
+    run("receiver repeats frame", staleMs, false);
+    run("link up", 500, true);
+    pad.setConnected(false);
+    run("link down", outageMs, true);
+    pad.setConnected(true);
+    run("link up", 500, true);
+    pad.setConnected(false);
+    pad.powerCycle();
+    run("link down, pad reset", outageMs, true);
+    pad.setConnected(true);
+    run("link up", 500, true);
+
+    const ps2::LinkStats stats = controller.linkStats();
+    printf("frames %lu, stale %lu, dropped %lu\n", (unsigned long)stats.frames, (unsigned long)stats.staleFrames,
+           (unsigned long)stats.droppedFrames);
+    printf("dropouts %u, resyncs %u, reconfigurations %u, longest dropout %lu ms, oldest held frame %lu ms\n",
+           stats.dropouts, stats.resyncs, stats.reconfigurations, stats.longestDropoutMs, maxHeldAgeMs);
+    printf("pad mode 0x%02X, held button %s\n", static_cast<int>(pad.mode()), buttonLost ? "lost" : "kept");
+    return (buttonLost || pad.mode() != Pad::Mode::Analog ? 2 : 0);
+}
+
+} // namespace sim
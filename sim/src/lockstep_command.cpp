@@ -0,0 +1,91 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_lockstep.hpp"
+
+#include <stdio.h>
+
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+// DAT lines on PORTB next to the default one on pin 12.
+constexpr uint8_t  dataPins[]    = { 12, 8, 9 };
+constexpr uint8_t  maxPads       = sizeof(dataPins) / sizeof(dataPins[0]);
+constexpr uint16_t padButtons[]  = { PSB_CROSS, PSB_CIRCLE | PSB_L1, PSB_START | PSB_PAD_UP };
+constexpr uint64_t pollPeriodNs  = 16000000;
+
+} // namespace
+
+// Polls the same pads one controller at a time and as a lockstep group, checks that both see the buttons of the
+// right pad and compares the bus time per poll.
+int lockstepCommand(int argc, char *argv[])
+{
+    const uint64_t padCount  = optionNumber(argc, argv, "--pads", maxPads);
+    const uint64_t polls     = optionNumber(argc, argv, "--polls", 100);
+    const bool     pressures = optionFlag(argc, argv, "--pressures");
+    const bool     digital   = optionFlag(argc, argv, "--digital");
+    const uint8_t  needs
+        = (digital ? ps2::needs::buttons : (pressures ? ps2::needs::pressures : ps2::needs::sticks));
+    if (padCount == 0 || padCount > maxPads) {
+        fprintf(stderr, "--pads must be 1..%u\n", static_cast<unsigned>(maxPads));
+        return 1;
+    }
+
+    resetSimulation();
+    const BusPins                    &pins = defaultPins;
+    std::vector<std::unique_ptr<Pad>> pads;
+    std::vector<ps2::Controller>      controllers(padCount);
+    ps2::LockstepGroup                group;
+    for (uint64_t i = 0; i < padCount; ++i) {
+        pads.push_back(std::make_unique<Pad>(pins.clock, pins.command, pins.attention, dataPins[i]));
+    }
+    for (uint64_t i = 0; i < padCount; ++i) {
+        if (controllers[i].configure(pins.clock, pins.command, pins.attention, dataPins[i], needs)
+                != ps2::ErrorCode::Success
+            || !group.add(controllers[i])) {
+            fprintf(stderr, "pad %u: configure failed\n", static_cast<unsigned>(i));
+            return 1;
+        }
+        pads[i]->press(padButtons[i]);
+    }
+
+    uint64_t serialNs   = 0;
+    uint64_t lockstepNs = 0;
+    uint64_t mismatches = 0;
+    const auto checkButtons = [&] {
+        for (uint64_t i = 0; i < padCount; ++i) {
+            mismatches += (controllers[i].pressedButtons() != padButtons[i] ? 1 : 0);
+        }
+    };
+    for (uint64_t poll = 0; poll < polls; ++poll) {
+        uint64_t startNs = clock().nowNs();
+        for (ps2::Controller &controller : controllers) {
+            controller.readData();
+        }
+        serialNs += clock().nowNs() - startNs;
+        checkButtons();
+        clock().advanceNs(pollPeriodNs);
+
+        startNs = clock().nowNs();
+        group.readData();
+        lockstepNs += clock().nowNs() - startNs;
+        checkButtons();
+        clock().advanceNs(pollPeriodNs);
+    }
+
+    printf("%u pads, %u-byte frames, %llu polls each\n", static_cast<unsigned>(padCount),
+           static_cast<unsigned>(controllers[0].frameBytes()), (unsigned long long)polls);
+    printf("  one controller at a time: %8.1f us per poll\n", serialNs / 1000.0 / polls);
+    printf("  lockstep group:           %8.1f us per poll\n", lockstepNs / 1000.0 / polls);
+    printf("  button mismatches:        %8llu\n", (unsigned long long)mismatches);
+    return (mismatches == 0 ? 0 : 2);
+}
+
+} // namespace sim
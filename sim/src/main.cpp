@@ -0,0 +1,86 @@
+#include "sim/commands.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+struct Command
+{
+    const char *name;
+    int (*run)(int argc, char *argv[]);
+    const char *usage;
+};
+
+const Command commands[] = {
+    { "trace", sim::traceCommand,
+      "[--out ps2.vcd] [--policy bit|byte|frame] [--limit name=ns]... [--handshake]\n"
+      "      Runs configure, readData and reconfiguration, writes a VCD file and checks bus timing.\n"
+      "      --handshake dumps the PS2_TRACE ring buffer afterwards." },
+    { "latency", sim::latencyCommand,
+      "[--changes 200] [--loop-us 16000] [--work-us 200] [--min-gap-ms 40] [--max-gap-ms 300]\n"
+      "        [--bucket-us 1013] [--pressures] [--seed 1]\n"
+      "      Scripted button changes against an application loop, reports latency percentiles per stage. The\n"
+      "      buckets default to covering two loop periods." },
+    { "lockstep", sim::lockstepCommand, "[--pads 3] [--polls 100] [--pressures] [--digital]\n"
+      "      Pads with DAT on pins 12, 8 and 9 polled one by one and as a lockstep group." },
+    { "spi", sim::spiCommand, "[--ms 2000] [--poll-ms 16] [--card-ms 20] [--radio-ms 5] [--ps2-hz 250000] [--pressures]\n"
+      "      PS2 frames over SPI interleaved with SD card and radio transfers, reports queue wait per client." },
+    { "link", sim::linkCommand, "[--poll-ms 16] [--outage-ms 300] [--stale-ms 800] [--stale-frames 30] [--seed 1]\n"
+      "      Stale frames, dropouts and a pad reset on a wireless link, reports status changes and link statistics." },
+    { "coprocessor", sim::coprocessorCommand,
+      "[--link i2c|uart] [--ms 2000] [--poll-ms 4] [--read-ms 20] [--tap-ms 8] [--tap-every-ms 53]\n"
+      "        [--i2c-hz 400000] [--baud 115200]\n"
+      "      Coprocessor polling the pad, main controller reading its register map, reports transfer and tap latency." },
+    { "governor", sim::governorCommand, "[--ms 60000] [--active-ms 4] [--idle-ms 100] [--quiet-ms 500] [--seed 1]\n"
+      "      Idle spells and input bursts polled at a fixed rate and by PollGovernor, reports bus time and latency." },
+    { "features", sim::featuresCommand, "[--polls 1000] [--decodes 2000000] [--seed 1]\n"
+      "      Bus time per poll and decode time per frame of the compiled-in PS2_* feature set." },
+    { "cache", sim::cacheCommand, "[--loops 2000] [--work-us 1000] [--drive-ms 5] [--ui-ms 20] [--telemetry-ms 50]\n"
+      "      Three readers per loop polling directly and through FrameCache, reports polls, loop time and hits." },
+    { "faults", sim::faultsCommand, "[--fault bitflip|missing-ack|slow-config-exit|unplug|receiver-0xff]\n"
+      "      Injects each fault into polling, configuration and reconfiguration, reports recovery time and lost input." },
+    { "record", sim::recordCommand, "[--out ps2.cap] [--frames 100000] [--poll-us 4000] [--pressures] [--seed 1]\n"
+      "      Polls a pad with wandering sticks and button taps, writes every frame to a capture file." },
+    { "decode", sim::decodeCommand, "[--in ps2.cap] [--threads 0] [--rounds 10]\n"
+      "      Memory-maps a capture and decodes it into columns, reports frames/s per kernel and thread count." },
+    { "history", sim::historyCommand, "[--polls 5000] [--poll-ms 16] [--window-ms 300] [--frames 4] [--seed 1]\n"
+      "      Random taps, holds and stick moves with a SnapshotHistory attached, checks its queries against a log scan." },
+    { "predict", sim::predictCommand, "[--in ps2.cap] [--horizons 4000,8000,16000] [--alpha 192] [--beta 64] [--overshoot 24]\n"
+      "      Replays a capture through StickPredictor, reports prediction error and latency gain per horizon." },
+    { "capabilities", sim::capabilitiesCommand, "[--polls 200]\n"
+      "      Configures by needs after capability discovery, reports the chosen frame and its bus time per poll." },
+    { "sleep", sim::sleepCommand, "[--ms 10000] [--period-us 4000] [--active-ua 9500] [--idle-ua 2600] [--pressures]\n"
+      "      Polls spinning and sleeping in IdleScheduler, reports poll timing, awake time and average current." },
+    { "guitar", sim::guitarCommand, "[--strums 500] [--periods-us 0,2000,4000,8000] [--min-gap-ms 40] [--max-gap-ms 200]\n"
+      "      [--seed 1]  Decodes scripted strums with GuitarDecoder and reports the strum timestamp jitter per period." },
+    { "group", sim::groupCommand, "[--pads 3] [--polls 1000] [--reads 20000] [--seed 1]\n"
+      "      Reads a ControllerGroup from random interrupts and counts reads that mixed two batches." },
+    { "api", sim::apiCommand, "[--case name]\n"
+      "      Regression cases of the Controller API against the simulated pad, exits with 2 when one fails." },
+};
+
+void printUsage()
+{
+    printf("Native PS2 bus simulator.\nUsage: ps2sim <command> [options]\n\n");
+    for (const Command &command : commands) {
+        printf("  %s %s\n", command.name, command.usage);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    for (const Command &command : commands) {
+        if (strcmp(command.name, argv[1]) == 0) {
+            return command.run(argc - 2, argv + 2);
+        }
+    }
+    printUsage();
+    return 1;
+}
@@ -0,0 +1,34 @@
+#include "sim/options.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace sim {
+
+const char *optionValue(int argc, char *argv[], const char *name, const char *defaultValue)
+{
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return defaultValue;
+}
+
+uint64_t optionNumber(int argc, char *argv[], const char *name, uint64_t defaultValue)
+{
+    const char *value = optionValue(argc, argv, name, nullptr);
+    return (value ? strtoull(value, nullptr, 0) : defaultValue);
+}
+
+bool optionFlag(int argc, char *argv[], const char *name)
+{
+    for (int i = 0; i < argc; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace sim
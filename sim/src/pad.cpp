@@ -0,0 +1,354 @@
+#include "sim/pad.hpp"
+
+#include "ps2.hpp"
+
+#include <string.h>
+
+namespace sim {
+
+namespace {
+
+struct PressureButton
+{
+    uint16_t button;
+    uint8_t  buttonId;
+};
+
+constexpr PressureButton pressureButtons[] = {
+    { PSB_PAD_RIGHT, PSAB_PAD_RIGHT }, { PSB_PAD_LEFT, PSAB_PAD_LEFT }, { PSB_PAD_UP, PSAB_PAD_UP },
+    { PSB_PAD_DOWN, PSAB_PAD_DOWN },   { PSB_TRIANGLE, PSAB_TRIANGLE }, { PSB_CIRCLE, PSAB_CIRCLE },
+    { PSB_CROSS, PSAB_CROSS },         { PSB_SQUARE, PSAB_SQUARE },     { PSB_L1, PSAB_L1 },
+    { PSB_R1, PSAB_R1 },               { PSB_L2, PSAB_L2 },             { PSB_R2, PSAB_R2 },
+};
+
+// Replies of the configuration commands, bytes 3..8.
+constexpr uint8_t statusReply[]       = { 0x03, 0x02, 0x00, 0x02, 0x01, 0x00 };
+constexpr uint8_t constant46Reply0[]  = { 0x00, 0x00, 0x01, 0x02, 0x00, 0x0A };
+constexpr uint8_t constant46Reply1[]  = { 0x00, 0x00, 0x01, 0x01, 0x01, 0x14 };
+constexpr uint8_t constant47Reply[]   = { 0x00, 0x00, 0x02, 0x00, 0x01, 0x00 };
+constexpr uint8_t constant4CReply0[]  = { 0x00, 0x00, 0x00, 0x04, 0x00, 0x00 };
+constexpr uint8_t constant4CReply1[]  = { 0x00, 0x00, 0x00, 0x07, 0x00, 0x00 };
+constexpr uint8_t rumbleReply[]       = { 0x00, 0x01, 0xFF, 0xFF, 0xFF, 0xFF };
+constexpr uint8_t pressureModeReply[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x5A };
+
+constexpr uint8_t headerSize            = 3;
+constexpr uint8_t digitalFrameSize      = 5;
+constexpr uint8_t analogFrameSize       = 9;
+constexpr uint8_t statusModesOffset     = 1;
+constexpr uint8_t statusAnalogOffset    = 2;
+constexpr uint8_t statusActuatorsOffset = 3;
+constexpr uint8_t configReplySize       = 6;
+
+} // namespace
+
+Pad::Pad(uint8_t clockPin, uint8_t commandPin, uint8_t attentionPin, uint8_t dataPin)
+    : clockPin_ { clockPin }, commandPin_ { commandPin }, attentionPin_ { attentionPin }, dataPin_ { dataPin }
+{
+    memset(command_, 0, sizeof(command_));
+    bus().attach(*this);
+}
+
+Pad::~Pad()
+{
+    bus().detach(*this);
+}
+
+void Pad::press(uint16_t buttons, uint8_t pressure)
+{
+    buttons_ |= buttons;
+    for (const PressureButton &entry : pressureButtons) {
+        if (buttons & entry.button) {
+            setPressure(entry.buttonId, pressure);
+        }
+    }
+}
+
+void Pad::release(uint16_t buttons)
+{
+    buttons_ &= ~buttons;
+    for (const PressureButton &entry : pressureButtons) {
+        if (buttons & entry.button) {
+            setPressure(entry.buttonId, 0);
+        }
+    }
+}
+
+void Pad::setStick(uint8_t stickId, uint8_t value)
+{
+    sticks_[stickId - PSS_RX] = value;
+}
+
+void Pad::setPressure(uint8_t buttonId, uint8_t value)
+{
+    pressureValues_[buttonId - PSAB_PAD_RIGHT] = value;
+}
+
+void Pad::setTypeId(uint8_t typeId)
+{
+    typeId_ = typeId;
+}
+
+void Pad::setTableSizes(uint8_t modes, uint8_t actuators)
+{
+    modeEntries_     = modes;
+    actuatorEntries_ = actuators;
+}
+
+uint16_t Pad::buttons() const
+{
+    return buttons_;
+}
+
+Pad::Mode Pad::mode() const
+{
+    if (config_) {
+        return Mode::Config;
+    }
+    if (analog_) {
+        return (pressures_ ? Mode::Pressure : Mode::Analog);
+    }
+    return Mode::Digital;
+}
+
+uint8_t Pad::smallMotor() const
+{
+    return smallMotor_;
+}
+
+uint8_t Pad::largeMotor() const
+{
+    return largeMotor_;
+}
+
+uint32_t Pad::frames() const
+{
+    return frames_;
+}
+
+void Pad::setConnected(bool connected)
+{
+    connected_ = connected;
+    if (!connected_) {
+        selected_ = false;
+        bus().release(dataPin_);
+    }
+}
+
+void Pad::powerCycle()
+{
+    config_       = false;
+    analog_       = false;
+    pressures_    = false;
+    rumbleMapped_ = false;
+    smallMotor_   = 0;
+    largeMotor_   = 0;
+}
+
+void Pad::injectFault(Fault fault, uint32_t frames, uint8_t byteIndex, uint8_t bit)
+{
+    fault_       = (frames > 0 ? fault : Fault::None);
+    faultFrames_ = frames;
+    faultByte_   = byteIndex;
+    faultBit_    = bit;
+}
+
+bool Pad::faultPending() const
+{
+    return (fault_ != Fault::None);
+}
+
+void Pad::pinChanged(uint8_t pin, bool level)
+{
+    if (pin == attentionPin_) {
+        if (level) {
+            endFrame();
+        } else {
+            beginFrame();
+        }
+    } else if (pin == clockPin_ && selected_) {
+        if (level) {
+            clockRising();
+        } else {
+            clockFalling();
+        }
+    }
+}
+
+void Pad::beginFrame()
+{
+    if (!connected_) {
+        // An unplugged pad counts the frames it misses and comes back as a freshly powered one.
+        if (fault_ == Fault::Unplug) {
+            faultFrameDone();
+            if (fault_ == Fault::None) {
+                powerCycle();
+                connected_ = true;
+            }
+        }
+        return;
+    }
+    selected_    = true;
+    byteIndex_   = 0;
+    bitIndex_    = 0;
+    commandByte_ = 0;
+    memset(command_, 0, sizeof(command_));
+}
+
+void Pad::endFrame()
+{
+    if (!selected_) {
+        return;
+    }
+    selected_ = false;
+    bus().release(dataPin_);
+    ++frames_;
+    if (fault_ == Fault::BitFlip || fault_ == Fault::MissingAck || fault_ == Fault::ReceiverIdle) {
+        faultFrameDone();
+    }
+
+    switch (command_[1]) {
+        case 0x42:
+            smallMotor_ = (rumbleMapped_ ? command_[3] : 0);
+            largeMotor_ = (rumbleMapped_ ? command_[4] : 0);
+            break;
+        case 0x43:
+            if (command_[3] == 0x01) {
+                config_ = true;
+            } else if (config_ && command_[3] == 0x00) {
+                if (fault_ == Fault::SlowConfigExit) {
+                    faultFrameDone();
+                } else {
+                    config_ = false;
+                }
+            }
+            break;
+        case 0x44:
+            if (config_) {
+                analog_ = (command_[3] == 0x01);
+            }
+            break;
+        case 0x4D:
+            if (config_) {
+                rumbleMapped_ = (command_[3] == 0x00 && command_[4] == 0x01);
+            }
+            break;
+        case 0x4F:
+            if (config_) {
+                pressures_ = ((command_[3] | command_[4] | command_[5]) != 0);
+            }
+            break;
+    }
+}
+
+// Data changes on the falling edge, a new byte starts with its first bit.
+void Pad::clockFalling()
+{
+    if (bitIndex_ == 0) {
+        response_ = responseByte(byteIndex_);
+        if (fault_ == Fault::BitFlip && byteIndex_ == faultByte_) {
+            response_ ^= static_cast<uint8_t>(1u << faultBit_);
+        } else if (fault_ == Fault::Unplug && byteIndex_ == faultByte_) {
+            setConnected(false);
+            return;
+        }
+    }
+    const bool silent = (fault_ == Fault::ReceiverIdle || (fault_ == Fault::MissingAck && byteIndex_ >= faultByte_));
+    if (byteIndex_ < frameSize() && !silent) {
+        bus().drive(dataPin_, response_ & (1u << bitIndex_));
+    } else {
+        bus().release(dataPin_);
+    }
+}
+
+void Pad::clockRising()
+{
+    if (bus().level(commandPin_)) {
+        commandByte_ |= static_cast<uint8_t>(1u << bitIndex_);
+    }
+    if (++bitIndex_ < 8) {
+        return;
+    }
+    if (byteIndex_ < maxFrameSize) {
+        command_[byteIndex_] = commandByte_;
+    }
+    ++byteIndex_;
+    bitIndex_    = 0;
+    commandByte_ = 0;
+}
+
+// Bytes after the header may depend on command bytes already received, so they are computed when they start.
+uint8_t Pad::responseByte(uint8_t index) const
+{
+    if (index == 0 || index >= frameSize()) {
+        return 0xFF;
+    }
+    if (index == 1) {
+        return static_cast<uint8_t>(mode());
+    }
+    if (index == 2) {
+        return 0x5A;
+    }
+
+    if (command_[1] == 0x42 || (command_[1] == 0x43 && !config_)) {
+        return pollByte(index);
+    }
+    const uint8_t replyIndex = index - headerSize;
+    if (replyIndex >= configReplySize) {
+        return 0x00;
+    }
+    switch (command_[1]) {
+        case 0x45:
+            if (replyIndex == statusAnalogOffset) {
+                return (analog_ ? 0x01 : 0x00);
+            }
+            if (replyIndex == 0) {
+                return typeId_;
+            }
+            if (replyIndex == statusModesOffset) {
+                return modeEntries_;
+            }
+            if (replyIndex == statusActuatorsOffset) {
+                return actuatorEntries_;
+            }
+            return statusReply[replyIndex];
+        case 0x46: return (command_[3] == 0x00 ? constant46Reply0 : constant46Reply1)[replyIndex];
+        case 0x47: return constant47Reply[replyIndex];
+        case 0x4C: return (command_[3] == 0x00 ? constant4CReply0 : constant4CReply1)[replyIndex];
+        case 0x4D: return rumbleReply[replyIndex];
+        case 0x4F: return pressureModeReply[replyIndex];
+        default: return 0x00;
+    }
+}
+
+uint8_t Pad::pollByte(uint8_t index) const
+{
+    const uint16_t activeLowButtons = static_cast<uint16_t>(~buttons_);
+    if (index == 3) {
+        return static_cast<uint8_t>(activeLowButtons);
+    }
+    if (index == 4) {
+        return static_cast<uint8_t>(activeLowButtons >> 8);
+    }
+    if (index < PSAB_PAD_RIGHT) {
+        return sticks_[index - PSS_RX];
+    }
+    return pressureValues_[index - PSAB_PAD_RIGHT];
+}
+
+void Pad::faultFrameDone()
+{
+    if (--faultFrames_ == 0) {
+        fault_ = Fault::None;
+    }
+}
+
+uint8_t Pad::frameSize() const
+{
+    switch (mode()) {
+        case Mode::Digital: return digitalFrameSize;
+        case Mode::Pressure: return maxFrameSize;
+        default: return analogFrameSize;
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,167 @@
+#include "sim/capture.hpp"
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+
+#include "ps2.hpp"
+#include "ps2_predictor.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+constexpr uint32_t holdCurveStepUs = 250;
+constexpr uint8_t  stickChannels   = 4;
+
+struct Variant
+{
+    const char *name;
+    uint16_t    alpha;
+    uint16_t    beta;
+    byte        overshoot;
+};
+
+struct ErrorStats
+{
+    double   meanError;
+    unsigned p99;
+    unsigned maximum;
+};
+
+// Stick value at timeUs, interpolated between the two recorded frames around it.
+double truthAt(const FrameColumns &columns, uint8_t channel, size_t before, uint32_t timeUs)
+{
+    const uint32_t spanUs = columns.timestampUs[before + 1] - columns.timestampUs[before];
+    const double   weight = static_cast<double>(timeUs - columns.timestampUs[before]) / spanUs;
+    const double   from   = columns.analog[channel][before];
+    return from + (columns.analog[channel][before + 1] - from) * weight;
+}
+
+// Replays every frame through a fresh predictor and compares its prediction horizonUs ahead with the capture.
+ErrorStats evaluate(const FrameColumns &columns, const Variant &variant, uint32_t horizonUs)
+{
+    ps2::StickPredictor predictor;
+    predictor.setGains(variant.alpha, variant.beta);
+    predictor.setOvershootLimit(variant.overshoot);
+    unsigned     histogram[256] = {};
+    double       errorSum       = 0;
+    unsigned     samples        = 0;
+    const size_t frames         = columns.timestampUs.size();
+    size_t       before         = 0;
+    for (size_t i = 0; i < frames; ++i) {
+        const byte sticks[stickChannels]
+            = { columns.analog[0][i], columns.analog[1][i], columns.analog[2][i], columns.analog[3][i] };
+        predictor.update(sticks, columns.timestampUs[i]);
+        const uint32_t targetUs = columns.timestampUs[i] + horizonUs;
+        while (before + 1 < frames && columns.timestampUs[before + 1] <= targetUs) {
+            ++before;
+        }
+        if (before + 1 >= frames) {
+            break;
+        }
+        for (uint8_t channel = 0; channel < stickChannels; ++channel) {
+            const double   error = abs(predictor.predict(PSS_RX + channel, targetUs)
+                                     - truthAt(columns, channel, before, targetUs));
+            const unsigned bucket = static_cast<unsigned>(error + 0.5);
+            errorSum += error;
+            ++histogram[bucket > 255 ? 255 : bucket];
+            ++samples;
+        }
+    }
+    ErrorStats stats { (samples ? errorSum / samples : 0), 0, 0 };
+    unsigned   seen = 0;
+    for (unsigned bucket = 0; bucket < 256; ++bucket) {
+        seen += histogram[bucket];
+        stats.p99     = (seen * 100u < samples * 99u ? bucket + 1 : stats.p99);
+        stats.maximum = (histogram[bucket] ? bucket : stats.maximum);
+    }
+    return stats;
+}
+
+// Horizon at which simply holding the last frame is as far off as meanError, interpolated on the hold error curve.
+// Negative when the curve never gets that far off.
+double equivalentHoldUs(const std::vector<double> &holdCurve, double meanError)
+{
+    for (size_t i = 1; i < holdCurve.size(); ++i) {
+        if (holdCurve[i] >= meanError) {
+            const double rise = holdCurve[i] - holdCurve[i - 1];
+            const double part = (rise > 0 ? (meanError - holdCurve[i - 1]) / rise : 0);
+            return (i - 1 + (part < 0 ? 0 : part)) * holdCurveStepUs;
+        }
+    }
+    return -1;
+}
+
+std::vector<uint32_t> parseHorizons(const char *list)
+{
+    std::vector<uint32_t> horizons;
+    char                 *end = nullptr;
+    for (const char *next = list; *next; next = (*end == ',' ? end + 1 : end)) {
+        horizons.push_back(static_cast<uint32_t>(strtoul(next, &end, 10)));
+        if (end == next) {
+            break;
+        }
+    }
+    return horizons;
+}
+
+} // namespace
+
+// Replays a capture from `ps2sim record` through StickPredictor with hold, linear extrapolation and alpha-beta
+// settings and reports the prediction error per horizon. The latency gain is how much of the horizon the prediction
+// takes back: the horizon minus the one at which holding the last frame has the same mean error.
+int predictCommand(int argc, char *argv[])
+{
+    const char                 *path      = optionValue(argc, argv, "--in", "ps2.cap");
+    const std::vector<uint32_t> horizons  = parseHorizons(optionValue(argc, argv, "--horizons", "4000,8000,16000"));
+    const uint16_t              alpha     = static_cast<uint16_t>(optionNumber(argc, argv, "--alpha", 192));
+    const uint16_t              beta      = static_cast<uint16_t>(optionNumber(argc, argv, "--beta", 64));
+    const byte                  overshoot = static_cast<byte>(optionNumber(argc, argv, "--overshoot", 24));
+
+    CaptureFile file;
+    if (!file.open(path) || file.frames() < 2) {
+        fprintf(stderr, "Can't map %s or it is not a capture file\n", path);
+        return 1;
+    }
+    FrameColumns columns;
+    columns.resize(file.frames());
+    decodeFrames(file, 0, file.frames(), columns, DecodeKernel::Scalar);
+
+    const Variant variants[] = {
+        { "hold", ps2::StickPredictor::gainOne, ps2::StickPredictor::gainOne, 0 },
+        { "linear", ps2::StickPredictor::gainOne, ps2::StickPredictor::gainOne, overshoot },
+        { "alpha-beta", alpha, beta, overshoot },
+        { "uncapped", alpha, beta, 0xFF },
+    };
+    uint32_t maxHorizonUs = 0;
+    for (uint32_t horizonUs : horizons) {
+        maxHorizonUs = (horizonUs > maxHorizonUs ? horizonUs : maxHorizonUs);
+    }
+    std::vector<double> holdCurve;
+    for (uint32_t horizonUs = 0; horizonUs <= 4 * maxHorizonUs; horizonUs += holdCurveStepUs) {
+        holdCurve.push_back(evaluate(columns, variants[0], horizonUs).meanError);
+    }
+
+    printf("%zu frames, alpha %u/256, beta %u/256, overshoot limit %u\n", file.frames(), static_cast<unsigned>(alpha),
+           static_cast<unsigned>(beta), static_cast<unsigned>(overshoot));
+    printf("%-8s %-11s %9s %5s %5s %10s\n", "horizon", "predictor", "mean err", "p99", "max", "gain us");
+    for (uint32_t horizonUs : horizons) {
+        for (const Variant &variant : variants) {
+            const ErrorStats stats    = evaluate(columns, variant, horizonUs);
+            const double     holdUs   = equivalentHoldUs(holdCurve, stats.meanError);
+            char             gain[16] = "worse";
+            if (holdUs >= 0) {
+                snprintf(gain, sizeof(gain), "%.0f", horizonUs - holdUs);
+            }
+            printf("%-8u %-11s %9.2f %5u %5u %10s\n", static_cast<unsigned>(horizonUs), variant.name,
+                   stats.meanError, stats.p99, stats.maximum, gain);
+        }
+    }
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,43 @@
+#include "sim/scenario.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace sim {
+
+void resetSimulation()
+{
+    clock().reset();
+    bus().reset();
+    SREG = static_cast<uint8_t>(1u << SREG_I);
+    SREG.resetStatistics();
+    timer0().reset();
+    sleepController().reset();
+}
+
+bool parseInterruptPolicy(const char *name, ps2::InterruptPolicy &policy)
+{
+    if (strcmp(name, "bit") == 0) {
+        policy = ps2::InterruptPolicy::PerBit;
+    } else if (strcmp(name, "byte") == 0) {
+        policy = ps2::InterruptPolicy::PerByte;
+    } else if (strcmp(name, "frame") == 0) {
+        policy = ps2::InterruptPolicy::PerFrame;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void printLatencyHeader()
+{
+    printf("%-12s %6s %8s %8s %8s %8s\n", "stage", "count", "p50 us", "p90 us", "p99 us", "max us");
+}
+
+void printLatency(const char *stage, const ps2::LatencyHistogram &histogram)
+{
+    printf("%-12s %6u %8lu %8lu %8lu %8lu\n", stage, histogram.count(), histogram.percentile(50),
+           histogram.percentile(90), histogram.percentile(99), histogram.maximum());
+}
+
+} // namespace sim
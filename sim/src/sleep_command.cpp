@@ -0,0 +1,124 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_sleep.hpp"
+
+#include <stdio.h>
+
+namespace sim {
+
+namespace {
+
+struct Run
+{
+    uint32_t polls         = 0;
+    uint64_t elapsedNs     = 0;
+    uint64_t awakeNs       = 0;
+    int64_t  minIntervalUs = 0;
+    int64_t  maxIntervalUs = 0;
+    uint64_t lateUs        = 0; // Sum of poll start times after their deadline.
+};
+
+void printRun(const char *name, const Run &run, uint64_t activeUa, uint64_t idleUa)
+{
+    const double duty = static_cast<double>(run.awakeNs) / run.elapsedNs;
+    printf("%-8s %6u %10lld %10lld %9.1f %8.1f%% %10.2f\n", name, static_cast<unsigned>(run.polls),
+           (long long)run.minIntervalUs, (long long)run.maxIntervalUs, static_cast<double>(run.lateUs) / (run.polls - 1),
+           duty * 100, (duty * activeUa + (1 - duty) * idleUa) / 1000.0);
+}
+
+} // namespace
+
+// Polls at a fixed period, once spinning in delayMicroseconds() to each deadline and once in IdleScheduler. Reports the
+// poll intervals, how late polls start, the awake time and the resulting average current. The scheduler's own awake
+// time is checked against the time the simulated CPU actually slept.
+int sleepCommand(int argc, char *argv[])
+{
+    const uint64_t durationMs = optionNumber(argc, argv, "--ms", 10000);
+    const uint64_t periodUs   = optionNumber(argc, argv, "--period-us", 4000);
+    const uint64_t activeUa   = optionNumber(argc, argv, "--active-ua", 9500); // ATmega328P at 16 MHz, 5 V.
+    const uint64_t idleUa     = optionNumber(argc, argv, "--idle-ua", 2600);
+    const bool     pressures  = optionFlag(argc, argv, "--pressures");
+
+    Run      runs[2];
+    uint32_t schedulerAwakeUs = 0;
+    uint32_t wakeups          = 0;
+    uint16_t dutyPermille     = 0;
+    for (int sleeping = 0; sleeping < 2; ++sleeping) {
+        resetSimulation();
+        const BusPins  &pins = defaultPins;
+        Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+        ps2::Controller controller {};
+        if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, pressures, false)
+            != ps2::ErrorCode::Success) {
+            fprintf(stderr, "configure failed\n");
+            return 1;
+        }
+        ps2::IdleScheduler scheduler;
+        scheduler.setPeriodUs(static_cast<unsigned long>(periodUs));
+        scheduler.resetStats();
+
+        Run           &run         = runs[sleeping];
+        const uint64_t startNs     = clock().nowNs();
+        const uint64_t endNs       = startNs + durationMs * 1000000;
+        uint64_t       deadlineUs  = startNs / 1000;
+        unsigned long  lastStartUs = 0;
+        while (clock().nowNs() < endNs) {
+            if (sleeping) {
+                scheduler.sleepUntilDue();
+            } else {
+                const uint64_t nowUs = clock().nowNs() / 1000;
+                delayMicroseconds(static_cast<unsigned int>(deadlineUs > nowUs ? deadlineUs - nowUs : 0));
+            }
+            pad.setStick(PSS_LX, static_cast<uint8_t>(run.polls));
+            controller.readData();
+            // The first poll after configure() waits for the configuration delay, the timing counts from the second.
+            const unsigned long startedUs = controller.frameStartedUs();
+            if (run.polls > 1) {
+                const int64_t intervalUs = static_cast<int64_t>(startedUs - lastStartUs);
+                run.minIntervalUs = (run.polls == 2 || intervalUs < run.minIntervalUs ? intervalUs : run.minIntervalUs);
+                run.maxIntervalUs = (intervalUs > run.maxIntervalUs ? intervalUs : run.maxIntervalUs);
+            }
+            if (run.polls > 0) {
+                run.lateUs += startedUs - (startNs / 1000 + run.polls * periodUs);
+            }
+            lastStartUs = startedUs;
+            deadlineUs += periodUs;
+            ++run.polls;
+        }
+        run.elapsedNs = clock().nowNs() - startNs;
+        run.awakeNs   = run.elapsedNs - sleepController().stats().sleptNs;
+        if (sleeping) {
+            schedulerAwakeUs = scheduler.awakeUs();
+            wakeups          = scheduler.wakeups();
+            dutyPermille     = scheduler.dutyCyclePermille();
+        }
+    }
+
+    const SleepController::Stats &stats = sleepController().stats();
+    printf("%llu ms, poll every %llu us, active %llu uA, idle %llu uA\n", (unsigned long long)durationMs,
+           (unsigned long long)periodUs, (unsigned long long)activeUa, (unsigned long long)idleUa);
+    printf("%-8s %6s %10s %10s %9s %9s %10s\n", "policy", "polls", "min gap us", "max gap us", "late us", "awake",
+           "avg mA");
+    printRun("spin", runs[0], activeUa, idleUa);
+    printRun("sleep", runs[1], activeUa, idleUa);
+    printf("scheduler: awake %lu us, duty cycle %u.%u%%, %lu wake-ups\n", static_cast<unsigned long>(schedulerAwakeUs),
+           static_cast<unsigned>(dutyPermille / 10), static_cast<unsigned>(dutyPermille % 10),
+           static_cast<unsigned long>(wakeups));
+    printf("simulated CPU: awake %llu us, %u sleeps, %u by compare B, %u lockups\n",
+           (unsigned long long)(runs[1].awakeNs / 1000), static_cast<unsigned>(stats.sleeps),
+           static_cast<unsigned>(stats.compareWakeups), static_cast<unsigned>(stats.lockups));
+
+    const bool sameTiming = (runs[0].polls == runs[1].polls && runs[1].maxIntervalUs <= runs[0].maxIntervalUs
+                           && runs[1].minIntervalUs >= runs[0].minIntervalUs);
+    // micros() truncates, each measured sleep can be off by up to a microsecond.
+    const int64_t awakeErrorUs = static_cast<int64_t>(schedulerAwakeUs) - static_cast<int64_t>(runs[1].awakeNs / 1000);
+    const bool    sameAwake    = (awakeErrorUs <= static_cast<int64_t>(wakeups) + 1
+                            && -awakeErrorUs <= static_cast<int64_t>(wakeups) + 1);
+    return (sameTiming && sameAwake && stats.lockups == 0 ? 0 : 2);
+}
+
+} // namespace sim
@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include <SPI.h>
+
+SPIClass SPI;
+
+namespace {
+
+constexpr uint8_t clockPolarityBit = 0x08;
+constexpr uint8_t clockPhaseBit    = 0x04;
+
+} // namespace
+
+// The AVR SPI master needs SS as an output, otherwise a low level on it would switch the peripheral to slave mode.
+void SPIClass::begin()
+{
+    pinMode(selectPin, OUTPUT);
+    pinMode(clockPin, OUTPUT);
+    pinMode(mosiPin, OUTPUT);
+    pinMode(misoPin, INPUT);
+}
+
+void SPIClass::end()
+{
+}
+
+void SPIClass::beginTransaction(SPISettings settings)
+{
+    settings_ = settings;
+    digitalWrite(clockPin, (settings_.dataMode_ & clockPolarityBit) ? HIGH : LOW);
+}
+
+void SPIClass::endTransaction()
+{
+}
+
+// With CPHA = 0 data is set up before the leading edge and sampled on it, with CPHA = 1 it is shifted out on the
+// leading edge and sampled on the trailing one.
+uint8_t SPIClass::transfer(uint8_t value)
+{
+    const uint64_t halfPeriodNs = 500000000ull / settings_.clockHz_;
+    const bool     idle         = (settings_.dataMode_ & clockPolarityBit);
+    const bool     clockPhase   = (settings_.dataMode_ & clockPhaseBit);
+    uint8_t        result       = 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        const uint8_t bit = (settings_.bitOrder_ == LSBFIRST ? i : 7 - i);
+        bool          sample;
+        if (clockPhase) {
+            sim::bus().write(clockPin, !idle);
+            sim::bus().write(mosiPin, value & (1u << bit));
+            sim::clock().advanceNs(halfPeriodNs);
+            sample = sim::bus().level(misoPin);
+            sim::bus().write(clockPin, idle);
+            sim::clock().advanceNs(halfPeriodNs);
+        } else {
+            sim::bus().write(mosiPin, value & (1u << bit));
+            sim::clock().advanceNs(halfPeriodNs);
+            sim::bus().write(clockPin, !idle);
+            sample = sim::bus().level(misoPin);
+            sim::clock().advanceNs(halfPeriodNs);
+            sim::bus().write(clockPin, idle);
+        }
+        if (sample) {
+            result |= static_cast<uint8_t>(1u << bit);
+        }
+    }
+    return result;
+}
+
+void SPIClass::transfer(void *buffer, size_t size)
+{
+    uint8_t *bytes = static_cast<uint8_t *>(buffer);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = transfer(bytes[i]);
+    }
+}
@@ -0,0 +1,126 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+
+#include "ps2.hpp"
+#include "ps2_spi.hpp"
+
+#include <stdio.h>
+
+namespace sim {
+
+namespace {
+
+constexpr uint8_t  cardSelectPin  = 4;
+constexpr uint8_t  radioSelectPin = 7;
+constexpr uint16_t cardBlockSize  = 512;
+constexpr uint16_t radioPayload   = 32;
+constexpr uint64_t idleStepNs     = 50000;
+
+// A periodic writer standing in for the SD card logger or the radio.
+struct PeriodicClient
+{
+    ps2::SpiClient   client;
+    ps2::SpiTransfer transfer;
+    uint64_t         periodNs;
+    uint64_t         nextNs;
+    uint8_t          buffer[cardBlockSize];
+    bool             queued;
+
+    PeriodicClient(uint8_t selectPin, uint32_t clockHz, uint16_t size, uint64_t periodMs)
+        : client { selectPin, SPISettings(clockHz, MSBFIRST, SPI_MODE0) },
+          transfer { &client, buffer, size, done, this, 0, 0 },
+          periodNs { periodMs * 1000000 },
+          nextNs { 0 },
+          buffer {},
+          queued { false }
+    {
+    }
+
+    void submitIfDue(ps2::SpiArbiter &arbiter)
+    {
+        if (!queued && clock().nowNs() >= nextNs) {
+            queued = arbiter.submit(transfer);
+            nextNs += periodNs;
+        }
+    }
+
+    static void done(ps2::SpiTransfer &transfer) { static_cast<PeriodicClient *>(transfer.context)->queued = false; }
+};
+
+void printClient(const char *name, const ps2::SpiClient &client)
+{
+    printf("%-8s %9u %12lu %12lu\n", name, static_cast<unsigned>(client.transfers()), client.averageWaitUs(),
+           client.maxWaitUs());
+}
+
+} // namespace
+
+// Configures the pad by bit-banging, then polls it over the simulated SPI peripheral while an SD card logger and a
+// radio share the bus, and reports how long each client waited for it.
+int spiCommand(int argc, char *argv[])
+{
+    const uint64_t durationMs = optionNumber(argc, argv, "--ms", 2000);
+    const uint64_t pollMs     = optionNumber(argc, argv, "--poll-ms", 16);
+    const uint64_t cardMs     = optionNumber(argc, argv, "--card-ms", 20);
+    const uint64_t radioMs    = optionNumber(argc, argv, "--radio-ms", 5);
+    const uint64_t ps2ClockHz = optionNumber(argc, argv, "--ps2-hz", ps2::SpiPoller::defaultClockHz);
+    const bool     pressures  = optionFlag(argc, argv, "--pressures");
+
+    resetSimulation();
+    const BusPins  &pins = defaultPins;
+    Pad             pad(pins.clock, pins.command, pins.attention, pins.data);
+    ps2::Controller controller {};
+    if (controller.configure(pins.clock, pins.command, pins.attention, pins.data, pressures, false)
+        != ps2::ErrorCode::Success) {
+        fprintf(stderr, "configure failed\n");
+        return 1;
+    }
+
+    ps2::SpiArbiter arbiter;
+    ps2::SpiPoller  poller(arbiter, controller, pins.attention, static_cast<uint32_t>(ps2ClockHz));
+    PeriodicClient  card(cardSelectPin, 8000000, cardBlockSize, cardMs);
+    PeriodicClient  radio(radioSelectPin, 8000000, radioPayload, radioMs);
+    ps2::SpiClient *const clients[] = { &poller.client(), &card.client, &radio.client };
+    arbiter.begin(clients, sizeof(clients) / sizeof(clients[0]));
+
+    const uint16_t buttons       = PSB_CROSS | PSB_R1;
+    const uint64_t endNs         = clock().nowNs() + durationMs * 1000000;
+    uint64_t       nextPollNs    = clock().nowNs();
+    uint64_t       mismatches    = 0;
+    uint32_t       frames        = 0;
+    bool           expectPressed = false;
+    while (clock().nowNs() < endNs) {
+        // The other clients are queued first, so a poll that falls due together with them waits for their transfers.
+        card.submitIfDue(arbiter);
+        radio.submitIfDue(arbiter);
+        if (clock().nowNs() >= nextPollNs && poller.request()) {
+            nextPollNs += pollMs * 1000000;
+            expectPressed = !expectPressed;
+            if (expectPressed) {
+                pad.press(buttons);
+            } else {
+                pad.release(buttons);
+            }
+        }
+
+        const bool polled = poller.pending();
+        if (!arbiter.service()) {
+            clock().advanceNs(idleStepNs);
+        } else if (polled && !poller.pending()) {
+            ++frames;
+            mismatches += (controller.pressedButtons() != (expectPressed ? buttons : 0) ? 1 : 0);
+        }
+    }
+
+    printf("%u PS2 frames over SPI at %llu Hz, %llu decoded wrong, pad mode 0x%02X\n", static_cast<unsigned>(frames),
+           (unsigned long long)ps2ClockHz, (unsigned long long)mismatches, static_cast<int>(pad.mode()));
+    printf("%-8s %9s %12s %12s\n", "client", "transfers", "avg wait us", "max wait us");
+    printClient("ps2", poller.client());
+    printClient("card", card.client);
+    printClient("radio", radio.client);
+    return (mismatches == 0 && frames > 0 ? 0 : 2);
+}
+
+} // namespace sim
@@ -0,0 +1,191 @@
+#include "sim/trace.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace sim {
+
+namespace {
+
+// VCD identifiers are printable characters starting from '!'.
+char vcdIdentifier(size_t signalIndex)
+{
+    return static_cast<char>('!' + signalIndex);
+}
+
+} // namespace
+
+Trace::Trace() : startNs_ { clock().nowNs() }
+{
+    bus().attach(*this);
+}
+
+Trace::~Trace()
+{
+    bus().detach(*this);
+}
+
+void Trace::addSignal(uint8_t pin, const char *name)
+{
+    signals_.push_back({ pin, name, bus().level(pin) });
+}
+
+const std::vector<Transition> &Trace::transitions() const
+{
+    return transitions_;
+}
+
+bool Trace::writeVcd(const char *path) const
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    fprintf(file, "$timescale 1ns $end\n$scope module ps2 $end\n");
+    for (size_t i = 0; i < signals_.size(); ++i) {
+        fprintf(file, "$var wire 1 %c %s $end\n", vcdIdentifier(i), signals_[i].name.c_str());
+    }
+    fprintf(file, "$upscope $end\n$enddefinitions $end\n#%llu\n$dumpvars\n", (unsigned long long)startNs_);
+    for (size_t i = 0; i < signals_.size(); ++i) {
+        fprintf(file, "%d%c\n", signals_[i].initialLevel ? 1 : 0, vcdIdentifier(i));
+    }
+    fprintf(file, "$end\n");
+
+    uint64_t lastTimeNs = startNs_;
+    for (const Transition &transition : transitions_) {
+        if (transition.timeNs != lastTimeNs) {
+            fprintf(file, "#%llu\n", (unsigned long long)transition.timeNs);
+            lastTimeNs = transition.timeNs;
+        }
+        for (size_t i = 0; i < signals_.size(); ++i) {
+            if (signals_[i].pin == transition.pin) {
+                fprintf(file, "%d%c\n", transition.level ? 1 : 0, vcdIdentifier(i));
+            }
+        }
+    }
+
+    return (fclose(file) == 0);
+}
+
+void Trace::clear()
+{
+    transitions_.clear();
+    startNs_ = clock().nowNs();
+    for (Signal &signal : signals_) {
+        signal.initialLevel = bus().level(signal.pin);
+    }
+}
+
+void Trace::pinChanged(uint8_t pin, bool level)
+{
+    for (const Signal &signal : signals_) {
+        if (signal.pin == pin) {
+            transitions_.push_back({ clock().nowNs(), pin, level });
+            return;
+        }
+    }
+}
+
+bool ProtocolLimits::set(const char *name, uint64_t value)
+{
+    struct Field
+    {
+        const char *name;
+        uint64_t   *value;
+    };
+    const Field fields[] = {
+        { "clockLow", &minClockLowNs },
+        { "clockHigh", &minClockHighNs },
+        { "setup", &minSetupNs },
+        { "hold", &minHoldNs },
+        { "attentionSetup", &minAttentionSetupNs },
+        { "byteGap", &minByteGapNs },
+        { "maxByteGap", &maxByteGapNs },
+        { "frameGap", &minFrameGapNs },
+    };
+    for (const Field &field : fields) {
+        if (strcmp(field.name, name) == 0) {
+            *field.value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Walks the transitions once, keeping the time of the last edge of each line and the position inside the byte.
+std::vector<Violation> checkProtocol(const Trace &trace, const BusPins &pins, const ProtocolLimits &limits)
+{
+    std::vector<Violation> violations;
+    const auto check = [&violations](const char *rule, uint64_t timeNs, uint64_t measuredNs, uint64_t limitNs,
+                                     bool isMinimum) {
+        if (isMinimum ? measuredNs < limitNs : measuredNs > limitNs) {
+            violations.push_back({ rule, timeNs, measuredNs, limitNs, "ns" });
+        }
+    };
+
+    bool     selected        = false;
+    bool     frameSeen       = false;
+    bool     holdPending     = false;
+    bool     firstByte       = true;
+    uint8_t  bitIndex        = 0;
+    uint64_t attentionFallNs = 0;
+    uint64_t attentionRiseNs = 0;
+    uint64_t clockFallNs     = 0;
+    uint64_t clockRiseNs     = 0;
+    uint64_t commandChangeNs = 0;
+
+    for (const Transition &transition : trace.transitions()) {
+        const uint64_t now = transition.timeNs;
+        if (transition.pin == pins.attention) {
+            if (!transition.level) {
+                if (frameSeen) {
+                    check("frameGap", now, now - attentionRiseNs, limits.minFrameGapNs, true);
+                }
+                selected        = true;
+                firstByte       = true;
+                bitIndex        = 0;
+                holdPending     = false;
+                attentionFallNs = now;
+            } else if (selected) {
+                if (bitIndex != 0) {
+                    violations.push_back({ "partialByte", now, bitIndex, 8, "bits" });
+                }
+                selected        = false;
+                frameSeen       = true;
+                attentionRiseNs = now;
+            }
+        } else if (transition.pin == pins.command) {
+            if (selected && holdPending) {
+                check("hold", now, now - clockRiseNs, limits.minHoldNs, true);
+            }
+            holdPending     = false;
+            commandChangeNs = now;
+        } else if (transition.pin == pins.clock && selected) {
+            if (!transition.level) {
+                if (bitIndex == 0 && firstByte) {
+                    check("attentionSetup", now, now - attentionFallNs, limits.minAttentionSetupNs, true);
+                } else if (bitIndex == 0) {
+                    check("byteGap", now, now - clockRiseNs, limits.minByteGapNs, true);
+                    check("maxByteGap", now, now - clockRiseNs, limits.maxByteGapNs, false);
+                } else {
+                    check("clockHigh", now, now - clockRiseNs, limits.minClockHighNs, true);
+                }
+                clockFallNs = now;
+            } else {
+                check("clockLow", now, now - clockFallNs, limits.minClockLowNs, true);
+                check("setup", now, now - commandChangeNs, limits.minSetupNs, true);
+                clockRiseNs = now;
+                holdPending = true;
+                if (++bitIndex == 8) {
+                    bitIndex  = 0;
+                    firstByte = false;
+                }
+            }
+        }
+    }
+
+    return violations;
+}
+
+} // namespace sim
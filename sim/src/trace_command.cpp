@@ -0,0 +1,115 @@
+#include "sim/commands.hpp"
+#include "sim/options.hpp"
+#include "sim/pad.hpp"
+#include "sim/scenario.hpp"
+#include "sim/trace.hpp"
+
+#include "ps2.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+
+namespace sim {
+
+namespace {
+
+constexpr unsigned long reconfigurationWaitMs = 1600;
+constexpr size_t        reportedViolations    = 3;
+
+bool applyLimits(int argc, char *argv[], ProtocolLimits &limits)
+{
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "--limit") != 0) {
+            continue;
+        }
+        const std::string limit = argv[i + 1];
+        const size_t      split = limit.find('=');
+        if (split == std::string::npos
+            || !limits.set(limit.substr(0, split).c_str(), strtoull(limit.c_str() + split + 1, nullptr, 0))) {
+            fprintf(stderr, "Unknown limit %s\n", argv[i + 1]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void printViolations(const std::vector<Violation> &violations)
+{
+    std::map<std::string, std::vector<const Violation *>> byRule;
+    for (const Violation &violation : violations) {
+        byRule[violation.rule].push_back(&violation);
+    }
+    printf("Protocol check: %zu violations\n", violations.size());
+    for (const auto &[rule, ruleViolations] : byRule) {
+        const Violation &first = *ruleViolations.front();
+        printf("  %-15s %zu, limit %llu %s\n", rule.c_str(), ruleViolations.size(), (unsigned long long)first.limit,
+               first.unit);
+        for (size_t i = 0; i < ruleViolations.size() && i < reportedViolations; ++i) {
+            printf("    at %llu ns: %llu %s\n", (unsigned long long)ruleViolations[i]->timeNs,
+                   (unsigned long long)ruleViolations[i]->measured, ruleViolations[i]->unit);
+        }
+    }
+}
+
+} // namespace
+
+// Drives the library through configure() (sendCommandString and setControllerMode), polling and the reconfiguration
+// that readData() does after a long pause, while recording the bus.
+int traceCommand(int argc, char *argv[])
+{
+    const char          *path   = optionValue(argc, argv, "--out", "ps2.vcd");
+    ps2::InterruptPolicy policy = ps2::InterruptPolicy::PerBit;
+    if (!parseInterruptPolicy(optionValue(argc, argv, "--policy", "bit"), policy)) {
+        fprintf(stderr, "Unknown interrupt policy\n");
+        return 1;
+    }
+    ProtocolLimits limits;
+    if (!applyLimits(argc, argv, limits)) {
+        return 1;
+    }
+
+    resetSimulation();
+    const BusPins &pins = defaultPins;
+    Pad            pad(pins.clock, pins.command, pins.attention, pins.data);
+    Trace          trace;
+    trace.addSignal(pins.clock, "CLK");
+    trace.addSignal(pins.command, "CMD");
+    trace.addSignal(pins.attention, "ATT");
+    trace.addSignal(pins.data, "DAT");
+
+    ps2::Controller controller {};
+    controller.setInterruptPolicy(policy);
+    const ps2::ErrorCode error = controller.configure(pins.clock, pins.command, pins.attention, pins.data, true, true);
+    printf("configure: error %d, pad mode 0x%02X\n", static_cast<int>(error), static_cast<int>(pad.mode()));
+
+    pad.press(PSB_CROSS | PSB_PAD_UP);
+    controller.readData(true, 0x80);
+    pad.release(PSB_CROSS | PSB_PAD_UP);
+    controller.readData();
+    delay(reconfigurationWaitMs);
+    controller.readData();
+
+    if (!trace.writeVcd(path)) {
+        fprintf(stderr, "Can't write %s\n", path);
+        return 1;
+    }
+    printf("%u frames, %zu transitions written to %s\n", static_cast<unsigned>(pad.frames()),
+           trace.transitions().size(), path);
+    printf("Longest interrupts-off window: %llu ns\n", (unsigned long long)SREG.maxInterruptsOffNs());
+#ifdef PS2_TRACE
+    if (optionFlag(argc, argv, "--handshake")) {
+        printf("Last %u bytes of the handshake trace:\n", static_cast<unsigned>(ps2::traceBuffer.size()));
+        ps2::traceBuffer.dump(Serial);
+    }
+#endif
+
+    const std::vector<Violation> violations = checkProtocol(trace, pins, limits);
+    printViolations(violations);
+    return (violations.empty() ? 0 : 2);
+}
+
+} // namespace sim
@@ -0,0 +1,133 @@
+#include <Wire.h>
+
+#include "sim/bus.hpp"
+
+TwoWire           Wire;
+
+namespace {
+
+constexpr uint8_t bitsPerByte   = 9; // 8 data bits and the acknowledge.
+constexpr uint8_t startStopBits = 2;
+constexpr uint8_t addressNack   = 2;
+constexpr uint8_t emptyBusValue = 0xFF;
+
+} // namespace
+
+void TwoWire::begin()
+{
+    slaveAddress_ = -1;
+}
+
+void TwoWire::begin(uint8_t address)
+{
+    slaveAddress_ = address;
+}
+
+void TwoWire::end()
+{
+    slaveAddress_ = -1;
+}
+
+void TwoWire::setClock(uint32_t clockHz)
+{
+    clockHz_ = clockHz;
+}
+
+void TwoWire::onReceive(ReceiveHandler handler)
+{
+    receiveHandler_ = handler;
+}
+
+void TwoWire::onRequest(RequestHandler handler)
+{
+    requestHandler_ = handler;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    targetAddress_ = address;
+    transmitting_  = true;
+    txSize_        = 0;
+}
+
+// Delivers the written bytes to the slave as if its receive interrupt had fired after the stop condition.
+uint8_t TwoWire::endTransmission(bool)
+{
+    transmitting_ = false;
+    chargeBytes(1 + txSize_);
+    if (targetAddress_ != slaveAddress_) {
+        return addressNack;
+    }
+    memcpy(rxBuffer_, txBuffer_, txSize_);
+    rxSize_  = txSize_;
+    rxIndex_ = 0;
+    if (receiveHandler_) {
+        receiveHandler_(rxSize_);
+    }
+    rxSize_ = 0;
+    return 0;
+}
+
+// The slave fills the buffer from its request handler, bytes it doesn't provide read as an idle bus.
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool)
+{
+    if (quantity > bufferSize) {
+        quantity = bufferSize;
+    }
+    chargeBytes(1);
+    rxSize_  = 0;
+    rxIndex_ = 0;
+    if (address != slaveAddress_) {
+        return 0;
+    }
+    txSize_     = 0;
+    responding_ = true;
+    if (requestHandler_) {
+        requestHandler_();
+    }
+    responding_ = false;
+    memset(txBuffer_ + txSize_, emptyBusValue, bufferSize - txSize_);
+    memcpy(rxBuffer_, txBuffer_, quantity);
+    rxSize_ = quantity;
+    txSize_ = 0;
+    chargeBytes(quantity);
+    return quantity;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if ((!transmitting_ && !responding_) || txSize_ == bufferSize) {
+        return 0;
+    }
+    txBuffer_[txSize_++] = value;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1) {
+        ++written;
+    }
+    return written;
+}
+
+int TwoWire::available()
+{
+    return rxSize_ - rxIndex_;
+}
+
+int TwoWire::read()
+{
+    return (rxIndex_ < rxSize_ ? rxBuffer_[rxIndex_++] : -1);
+}
+
+int TwoWire::peek()
+{
+    return (rxIndex_ < rxSize_ ? rxBuffer_[rxIndex_] : -1);
+}
+
+void TwoWire::chargeBytes(size_t count) const
+{
+    sim::clock().advanceNs((count * bitsPerByte + startStopBits) * 1000000000ull / clockHz_);
+}
@@ -1,4 +1,9 @@
 #include "ps2.hpp"
+#include "ps2_buttons.hpp"
+#include "ps2_combo.hpp"
+#include "ps2_guitar.hpp"
+#include "ps2_rumble.hpp"
+#include "ps2_sleep.hpp"
 
 constexpr uint8_t       selectPin               = 10;
 constexpr uint8_t       commandPin              = 11;
@@ -9,16 +14,44 @@ constexpr bool          enableRumble            = true;
 constexpr unsigned long baudRate                = 57600;
 constexpr unsigned long serialMonitorStartDelay = 300;
 constexpr unsigned long readControllerDataDelay = 50;
+constexpr uint16_t      crossRumbleDurationMs   = 400;
+constexpr uint16_t      comboWindowMs           = 400;
+
+PS2_COMBO_TABLE(combos,
+                ps2::chord(PSB_START | PSB_SELECT),
+                ps2::sequence(comboWindowMs, PSB_PAD_DOWN, PSB_PAD_RIGHT, PSB_SQUARE));
 
 ps2::Controller ps2x;
 ps2::ErrorCode           error         ;
 ps2::ControllerType          controllerType ;
-byte          vibrate        = 0;
+ps2::Rumble          rumble;
+ps2::ButtonDispatcher buttons;
+ps2::ComboRecognizer<2> comboRecognizer(combos);
+ps2::IdleScheduler      scheduler;
+ps2::GuitarDecoder      guitar;
+
+void buttonPressedMessage(uint16_t button)
+{
+    switch (button) {
+        case PSB_L3: Serial.println("L3 pressed"); break;
+        case PSB_R3: Serial.println("R3 pressed"); break;
+        case PSB_L2: Serial.println("L2 pressed"); break;
+        case PSB_R2: Serial.println("R2 pressed"); break;
+        case PSB_GREEN: Serial.println("GREEN pressed"); break;
+        case PSB_RED: Serial.println("RED pressed"); break;
+        case PSB_BLUE:
+            Serial.println("BLUE pressed");
+            rumble.decay(ps2x.analogButtonState(PSAB_CROSS), crossRumbleDurationMs);
+            break;
+        case PSB_PINK: Serial.println("PINK pressed"); break;
+    }
+}
 
 void setup()
 {
     Serial.begin(baudRate);
     delay(serialMonitorStartDelay);
+    scheduler.setPeriodUs(readControllerDataDelay * 1000UL);
     error = ps2x.configure(clockPin, commandPin, selectPin, dataPin, pressureMode, enableRumble);
     if (error == ps2::ErrorCode::Success) {
         Serial.println("Found Controller, configured successful ");
@@ -33,9 +66,11 @@ void setup()
             Serial.println("ture");
         else
             Serial.println("false");
-        Serial.println("Try out all the buttons, X will vibrate the controller, faster as you press harder;");
+        Serial.println("Try out all the buttons, X will vibrate the controller, stronger as you press harder;");
         Serial.println("holding L1 or R1 will print out the analog stick values.");
         Serial.println("Note: Go to www.billporter.info for updates and to report bugs.");
+        buttons.on(PSB_L3 | PSB_R3 | PSB_L2 | PSB_R2 | PSB_GREEN | PSB_RED | PSB_BLUE | PSB_PINK,
+                   ps2::ButtonEvent::Press, buttonPressedMessage);
     } else if (error == ps2::ErrorCode::WrongControllerMode) {
         Serial.println("No controller found, check wiring, see readme.txt to enable debug. visit www.billporter.info "
                        "for troubleshooting tips");
@@ -45,6 +80,11 @@ void setup()
     } else if (error == ps2::ErrorCode::PressureModeError) {
         Serial.println("Controller refusing to enter Pressures mode, may not support it. ");
     }
+#ifdef PS2_TRACE
+    if (error != ps2::ErrorCode::Success) {
+        ps2::traceBuffer.dump(Serial);
+    }
+#endif
 
     controllerType = ps2x.type();
     switch (controllerType) {
@@ -59,7 +99,7 @@ void loop()
 {
     if (error == ps2::ErrorCode::WrongControllerMode)
         return;
-    if (error == ps2::ErrorCode::PressureModeError) {
+    if (ps2::config::guitarHero && error == ps2::ErrorCode::PressureModeError) {
         ps2x.readData();
         if (ps2x.buttonPressed(PSG_GREEN_FRET))
             Serial.println("Green Fret Pressed");
@@ -75,10 +115,14 @@ void loop()
         if (ps2x.buttonPressed(PSG_STAR_POWER))
             Serial.println("Star Power Command");
 
-        if (ps2x.buttonPressed(PSG_UP_STRUM))
-            Serial.println("Up Strum");
-        if (ps2x.buttonPressed(PSG_DOWN_STRUM))
-            Serial.println("DOWN Strum");
+        guitar.update(ps2x);
+        ps2::StrumEvent strum;
+        while (guitar.takeStrum(strum)) {
+            Serial.print(strum.direction == ps2::Strum::Up ? "Up Strum, lanes " : "Down Strum, lanes ");
+            Serial.print(strum.lanes, HEX);
+            Serial.print(" at ");
+            Serial.println(strum.timestampUs, DEC);
+        }
 
         if (ps2x.buttonPressed(PSB_START))
             Serial.println("Start is being held");
@@ -90,7 +134,12 @@ void loop()
             Serial.println(ps2x.analogButtonState(PSG_WHAMMY_BAR), DEC);
         }
     } else {
-        ps2x.readData(false, vibrate);
+        ps2x.readData(rumble);
+        buttons.dispatch(ps2x);
+        switch (comboRecognizer.update(ps2x)) {
+            case 0: Serial.println("START + SELECT chord"); break;
+            case 1: Serial.println("DOWN, RIGHT, SQUARE sequence"); break;
+        }
         if (ps2x.buttonPressed(PSB_START))
             Serial.println("Start is being held");
         if (ps2x.buttonPressed(PSB_SELECT))
@@ -113,26 +162,8 @@ void loop()
             Serial.println(ps2x.analogButtonState(PSAB_PAD_DOWN), DEC);
         }
 
-        vibrate = ps2x.analogButtonState(PSAB_CROSS);
-        if (ps2x.buttonsStateChanged()) {
-            if (ps2x.buttonPressed(PSB_L3))
-                Serial.println("L3 pressed");
-            if (ps2x.buttonPressed(PSB_R3))
-                Serial.println("R3 pressed");
-            if (ps2x.buttonPressed(PSB_L2))
-                Serial.println("L2 pressed");
-            if (ps2x.buttonPressed(PSB_R2))
-                Serial.println("R2 pressed");
-
-            if (ps2x.buttonPressed(PSB_GREEN))
-                Serial.println("GREEN pressed");
-            if (ps2x.buttonPressed(PSB_RED))
-                Serial.println("RED pressed");
-            if (ps2x.buttonPressed(PSB_BLUE))
-                Serial.println("BLUE pressed");
-            if (ps2x.buttonPressed(PSB_PINK))
-                Serial.println("PINK pressed");
-        }
+        if (ps2x.hardPressEdges() & ps2::Controller::pressureMaskBit(PSAB_CROSS))
+            Serial.println("X pressed hard");
 
         if (ps2x.buttonPressed(PSB_L1) || ps2x.buttonPressed(PSB_R1)) {
             Serial.print("Stick Values:");
@@ -145,5 +176,5 @@ void loop()
             Serial.println(ps2x.analogButtonState(PSS_RX), DEC);
         }
     }
-    delay(readControllerDataDelay);
+    scheduler.sleepUntilDue();
 }
@@ -1,13 +1,71 @@
 #include "ps2.hpp"
+#include "ps2_history.hpp"
+#include "ps2_rumble.hpp"
 
 #include <avr/io.h>
 #include <pins_arduino.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <avr/pgmspace.h>
 
 namespace ps2 {
 
+namespace {
+
+#if PS2_RUMBLE
+// Large motor values lower than 0x40 will not trigger the motor, so non-zero values are mapped onto 0x40..0xFF. Same
+// result as map(value, 0, 0xFF, 0x40, 0xFF), but without a 32-bit multiply and divide on every poll.
+struct MotorScaleTable
+{
+    constexpr MotorScaleTable() : values()
+    {
+        for (uint16_t i = 1; i < 256; ++i) {
+            values[i] = static_cast<byte>(i * (0xFF - 0x40) / 0xFF + 0x40);
+        }
+    }
+
+    byte values[256];
+};
+
+constexpr MotorScaleTable motorScaleTable PROGMEM;
+#endif
+
+// Busy wait for a constant time. On AVR it compiles to a cycle-counted loop without the call overhead and rounding of
+// delayMicroseconds(), which is only safe to rely on while interrupts are off.
+template<unsigned long us>
+inline void spinUs()
+{
+#ifdef __AVR__
+    __builtin_avr_delay_cycles(us * (F_CPU / 1000000UL));
+#else
+    delayMicroseconds(us);
+#endif
+}
+
+#if PS2_PRESSURES
+constexpr uint32_t laneHighBits = 0x80808080;
+
+// Compares four unsigned bytes at once: the high bit of a byte lane is set where the lane of x is at least the lane of
+// y. The low seven bits are compared by a subtraction that can't borrow across lanes, the high bits are fixed up
+// afterwards.
+uint32_t lanesAtLeast(uint32_t x, uint32_t y)
+{
+    const uint32_t low = (x | laneHighBits) - (y & ~laneHighBits);
+    return ((x & ~y) | (~(x ^ y) & low)) & laneHighBits;
+}
+
+// Collects the lane high bits into bits 0..3, lane 0 being the first byte in memory (little endian).
+uint8_t laneMask(uint32_t lanes)
+{
+    return static_cast<uint8_t>(((lanes >> 7) & 0x01) | ((lanes >> 14) & 0x02) | ((lanes >> 21) & 0x04)
+                                | ((lanes >> 28) & 0x08));
+}
+#endif
+
+} // namespace
+
 ErrorCode Controller::configure(uint8_t clockPin, uint8_t commandPin, uint8_t attentionPin, uint8_t dataPin)
 {
     return configure(clockPin, commandPin, attentionPin, dataPin, false, false);
@@ -15,9 +73,29 @@ ErrorCode Controller::configure(uint8_t clockPin, uint8_t commandPin, uint8_t at
 
 ErrorCode Controller::configure(
     uint8_t clockPin, uint8_t commandPin, uint8_t attentionPin, uint8_t dataPin, bool pressureMode, bool enableRumble)
+{
+    const uint8_t wanted = needs::sticks | (pressureMode ? needs::pressures : 0) | (enableRumble ? needs::rumble : 0);
+    return configure(clockPin, commandPin, attentionPin, dataPin, wanted);
+}
+
+// Queries the capabilities once and sets the pad to the shortest frame that carries everything in needs. Pressures
+// that the pad doesn't have give PressureModeError with the pad in analog mode, as before.
+ErrorCode Controller::configure(
+    uint8_t clockPin, uint8_t commandPin, uint8_t attentionPin, uint8_t dataPin, uint8_t needs)
 {
     const uint8_t oldSreg = SREG;
 
+    setPressureThresholds(defaultSoftPressure, defaultHardPressure, defaultPressureHysteresis);
+    setAnalogThreshold(defaultAnalogThreshold);
+    memset(analogReference_, 0, sizeof(analogReference_)); // The first frame reports every channel off 0 again.
+    capabilities_          = {};
+    expectedMode_          = 0;
+    frameStatus_           = FrameStatus::Valid;
+    staleFrameLimit_       = defaultStaleFrameLimit;
+    identicalFrames_       = 0;
+    lastReconfigurationMs_ = millis() - readPeriodUntilReconfiguration; // Allows one right away, see checkLink().
+    resetLinkStats();
+
     clockMask_               = maskToBitNum(digitalPinToBitMask(clockPin));
     clockOuputRegister_      = portOutputRegister(digitalPinToPort(clockPin));
     commandMask_             = maskToBitNum(digitalPinToBitMask(commandPin));
@@ -27,7 +105,11 @@ ErrorCode Controller::configure(
     dataMask_                = maskToBitNum(digitalPinToBitMask(dataPin));
     dataInputRegister_       = portInputRegister(digitalPinToPort(dataPin));
 
-    // Configure pins.
+    // Configure pins. The output latches are set first, so CLK, CMD and ATT come up idle high instead of pulling ATT
+    // low for what the pad would take as the start of a frame.
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(attentionPin, HIGH);
+    digitalWrite(commandPin, HIGH);
     pinMode(clockPin, OUTPUT);
     pinMode(attentionPin, OUTPUT);
     pinMode(commandPin, OUTPUT);
@@ -40,57 +122,63 @@ ErrorCode Controller::configure(
     SREG = oldSreg;
 
     // Error checking: reading controller's data for a few times, at the end PS2data[1] should be one of the values: 41,
-    // 73 or 79.
+    // 73 or 79. The frames are spaced like the config frames that follow.
+    readDelay_ = 1;
     readData();
     readData();
+    delay(readDelay_);
     if (data_[1] != correctMode1 && data_[1] != correctMode2 && data_[1] != correctMode3) {
-#ifdef PS2X_DEBUG
-        Serial.println("Controller mode not matched or no controller found");
-        Serial.print("Expected 0x41, 0x73 or 0x79, got ");
-        Serial.println(PS2data[1], HEX);
+#ifdef PS2_TRACE
+        traceBuffer.record(static_cast<uint8_t>(TraceSource::Error) | TraceBuffer::frameStart,
+                           static_cast<byte>(ErrorCode::WrongControllerMode), data_[1]);
 #endif
         return ErrorCode::WrongControllerMode;
     }
 
-    return setControllerMode(pressureMode, enableRumble);
+    return setControllerMode(needs);
 }
 
-ErrorCode Controller::setControllerMode(bool pressureMode, bool enableRumble)
+ErrorCode Controller::setControllerMode(uint8_t needs)
 {
-    byte answer[sizeof(commands::readType)];
-    readDelay_                       = 1; // readDelay_ will be saved to use later when reading data from controller.
-    const uint8_t            oldSreg = SREG;
+    // Features that are compiled out are never requested from the pad, see ps2_config.hpp.
+    const bool wantPressures = (needs & needs::pressures) && config::pressures;
+    bool       pressureMode  = wantPressures;
+    bool       enableRumble  = (needs & needs::rumble) && config::rumble;
+    bool       analogMode    = (needs & (needs::sticks | needs::pressures));
+    byte       answer[sizeof(commands::readType)];
+    readDelay_ = 1; // readDelay_ will be saved to use later when reading data from controller.
     static constexpr uint8_t maxAttempts = 10;
     for (uint8_t attempt = 0; attempt <= maxAttempts; ++attempt) {
         sendCommandString(commands::startConfiguration, sizeof(commands::startConfiguration)); // start config run
         delayMicroseconds(controlByteDelayUs);
 
-        cli();
-        setBit(*commandOutputRegister_, commandMask_);
-        setBit(*clockOuputRegister_, clockMask_);
-        clearBit(*attentionOutputRegister_, attentionMask_); // low enable joystick
-        SREG = oldSreg;
-
-        delayMicroseconds(controlByteDelayUs);
-
+        const uint8_t oldSreg = beginTransfer(TraceSource::ReadType);
         for (uint8_t j = 0; j < sizeof(commands::readType); ++j) {
             answer[j] = sendByte(commands::readType[j]);
         }
+        endTransfer(oldSreg);
+        delay(readDelay_); // Same gap as after every sendCommandString() frame.
 
-        cli();
-        setBit(*attentionOutputRegister_, attentionMask_); // HI disable joystick
-        SREG = oldSreg;
-
-        controllerType_ = static_cast<ControllerType>(answer[3]);
+        controllerType_ = controllerTypeOf(answer);
+        if (!capabilities_.discovered) {
+            discoverCapabilities(answer);
+        }
+        if (capabilities_.discovered) {
+            pressureMode = (wantPressures && capabilities_.pressures);
+            enableRumble = (enableRumble && capabilities_.actuators > 0);
+            analogMode   = (analogMode || !capabilities_.digital);
+        } else {
+            analogMode = true; // Without the mode table only analog mode is known to work.
+        }
 
-        sendCommandString(commands::setMode, sizeof(commands::setMode));
+        sendCommandString((analogMode ? commands::setMode : commands::setDigitalMode), sizeof(commands::setMode));
         if (enableRumble) {
             sendCommandString(commands::enableRumble, sizeof(commands::enableRumble));
             enableRumble_ = true;
         }
         if (pressureMode) {
             sendCommandString(commands::setAuxData, sizeof(commands::setAuxData));
-            pressureMode = true;
+            pressureMode_ = true;
         }
         sendCommandString(commands::stopConfiguration, sizeof(commands::stopConfiguration));
 
@@ -101,18 +189,23 @@ ErrorCode Controller::setControllerMode(bool pressureMode, bool enableRumble)
                 break;
             }
             if (data_[1] == correctMode2) {
+#ifdef PS2_TRACE
+                traceBuffer.record(static_cast<uint8_t>(TraceSource::Error) | TraceBuffer::frameStart,
+                                   static_cast<byte>(ErrorCode::PressureModeError), data_[1]);
+#endif
+                expectedMode_ = correctMode2;
+                memcpy(lastGoodData_, data_, sizeof(lastGoodData_));
                 return ErrorCode::PressureModeError;
             }
         }
-        if (data_[1] == correctMode2) {
+        if (data_[1] == (analogMode ? correctMode2 : correctMode1)) {
             break;
         }
 
         if (attempt == maxAttempts) {
-#ifdef PS2X_DEBUG
-            Serial.println("Controller not accepting commands");
-            Serial.print("mode stil set at");
-            Serial.println(PS2data[1], HEX);
+#ifdef PS2_TRACE
+            traceBuffer.record(static_cast<uint8_t>(TraceSource::Error) | TraceBuffer::frameStart,
+                               static_cast<byte>(ErrorCode::ControllerNotAcceptingCommands), data_[1]);
 #endif
             return ErrorCode::ControllerNotAcceptingCommands;
         }
@@ -120,9 +213,66 @@ ErrorCode Controller::setControllerMode(bool pressureMode, bool enableRumble)
         readDelay_ += 1;
     }
 
+    expectedMode_ = data_[1];
+    memcpy(lastGoodData_, data_, sizeof(lastGoodData_)); // A dropout right after configure() keeps this frame.
+    if (wantPressures && !pressureMode) {
+#ifdef PS2_TRACE
+        traceBuffer.record(static_cast<uint8_t>(TraceSource::Error) | TraceBuffer::frameStart,
+                           static_cast<byte>(ErrorCode::PressureModeError), data_[1]);
+#endif
+        return ErrorCode::PressureModeError;
+    }
     return ErrorCode::Success;
 }
 
+// ControllerType from the status reply (0x45). A reply that didn't come from configuration mode says nothing.
+ControllerType Controller::controllerTypeOf(const byte status[])
+{
+    if (status[1] != configModeId || status[2] != frameHeader) {
+        return ControllerType::Unknown;
+    }
+    switch (status[3]) {
+        case dualShock2TypeId: return ControllerType::DualShock;
+        case guitarHeroTypeId: return ControllerType::GuitarHero;
+        case wirelessTypeId: return ControllerType::WirelessDualShock;
+        default: return ControllerType::Unknown;
+    }
+}
+
+// Reads the actuator and mode tables whose sizes the status reply (0x45) announces, must run in configuration mode.
+void Controller::discoverCapabilities(const byte status[])
+{
+    if (status[1] != configModeId || status[2] != frameHeader) {
+        return;
+    }
+    capabilities_.discovered = true;
+    capabilities_.typeId     = status[3];
+    capabilities_.pressures  = (status[3] == dualShock2TypeId);
+
+    // Byte 4 counts the mode table entries, byte 6 the actuator table entries.
+    byte reply[sizeof(commands::queryMode)];
+    for (uint8_t i = 0; i < status[6] && i < maxTableEntries; ++i) {
+        queryConfiguration(commands::queryActuator, i, reply);
+        capabilities_.actuators += (reply[5] != 0);
+    }
+    capabilities_.modes = (status[4] < maxTableEntries ? status[4] : maxTableEntries);
+    for (uint8_t i = 0; i < capabilities_.modes; ++i) {
+        queryConfiguration(commands::queryMode, i, reply);
+        capabilities_.digital |= (reply[6] == digitalModeId);
+        capabilities_.analog |= (reply[6] == analogModeId);
+    }
+}
+
+void Controller::queryConfiguration(const byte command[], uint8_t index, byte reply[])
+{
+    const uint8_t oldSreg = beginTransfer(TraceSource::ReadType);
+    for (uint8_t i = 0; i < sizeof(commands::queryMode); ++i) {
+        reply[i] = sendByte(i == 3 ? index : command[i]);
+    }
+    endTransfer(oldSreg);
+    delay(readDelay_);
+}
+
 boolean Controller::buttonPressed(uint16_t button) const
 {
     return ((~buttonsState_ & button) > 0);
@@ -143,38 +293,301 @@ bool Controller::buttonStateChanged(uint16_t buttonId) const
     return (((previousButtonsState_ ^ buttonsState_) & buttonId) > 0);
 }
 
+// All pressed buttons as a PSB_* mask, active high.
+uint16_t Controller::pressedButtons() const
+{
+    return static_cast<uint16_t>(~buttonsState_);
+}
+
+// Buttons that were pressed or released by the last readData() as a PSB_* mask.
+uint16_t Controller::changedButtons() const
+{
+    return static_cast<uint16_t>(previousButtonsState_ ^ buttonsState_);
+}
+
 byte Controller::analogButtonState(uint16_t buttonId) const
 {
+    if constexpr (!config::pressures) {
+        if (buttonId >= frameSize) {
+            return 0;
+        }
+    }
     return data_[buttonId];
 }
 
+// Pressure buttons pressed harder than their hard threshold, bits follow PSAB_* starting from PSAB_PAD_RIGHT, see
+// pressureMaskBit(). Only updated in pressure mode. A bit is set once the pressure reaches the threshold and cleared
+// once it falls below threshold - hysteresis, so a pressure wobbling around the threshold doesn't toggle it.
+uint16_t Controller::pressureMask() const
+{
+#if PS2_PRESSURES
+    return hardPressureMask_;
+#else
+    return 0;
+#endif
+}
+
+// Same as pressureMask() for the soft threshold.
+uint16_t Controller::softPressureMask() const
+{
+#if PS2_PRESSURES
+    return softPressureMask_;
+#else
+    return 0;
+#endif
+}
+
+// Bits that were set in pressureMask() by the last readData().
+uint16_t Controller::hardPressEdges() const
+{
+#if PS2_PRESSURES
+    return hardPressEdges_;
+#else
+    return 0;
+#endif
+}
+
+uint16_t Controller::softPressEdges() const
+{
+#if PS2_PRESSURES
+    return softPressEdges_;
+#else
+    return 0;
+#endif
+}
+
+// configure() sets soft 0x20, hard 0xC0 and hysteresis 0x10 for all buttons.
+void Controller::setPressureThresholds(byte soft, byte hard, byte hysteresis)
+{
+    for (uint16_t buttonId = firstPressureChannel; buttonId < firstPressureChannel + auxDataSize; ++buttonId) {
+        setPressureThresholds(buttonId, soft, hard, hysteresis);
+    }
+}
+
+// Ids outside PSAB_PAD_RIGHT..PSAB_R2 are ignored.
+void Controller::setPressureThresholds(uint16_t buttonId, byte soft, byte hard, byte hysteresis)
+{
+#if PS2_PRESSURES
+    const uint16_t index = buttonId - firstPressureChannel;
+    if (index >= auxDataSize) {
+        return;
+    }
+    pressureThresholds_[SoftPress][index]   = soft;
+    pressureThresholds_[SoftRelease][index] = (soft > hysteresis ? soft - hysteresis : 0);
+    pressureThresholds_[HardPress][index]   = hard;
+    pressureThresholds_[HardRelease][index] = (hard > hysteresis ? hard - hysteresis : 0);
+#else
+    (void)buttonId;
+    (void)soft;
+    (void)hard;
+    (void)hysteresis;
+#endif
+}
+
+FrameStatus Controller::frameStatus() const
+{
+    return frameStatus_;
+}
+
+// Time since the last Valid frame. While the link is down readData() keeps returning the last good frame, so
+// applications that must not act on old input should check this, e.g. stop motors after 100 ms.
+unsigned long Controller::frameAgeMs() const
+{
+    return millis() - lastValidFrameMs_;
+}
+
+LinkStats Controller::linkStats() const
+{
+    return linkStats_;
+}
+
+void Controller::resetLinkStats()
+{
+    memset(&linkStats_, 0, sizeof(linkStats_));
+}
+
+// Number of identical frames in a row after which a wireless pad is reported as Stale, 0 disables the check. Only a
+// wireless receiver (status type byte 0x0C) is checked, wired pads are never reported as Stale. configure() resets it
+// to the default of 30 frames.
+void Controller::setStaleFrameLimit(uint8_t frames)
+{
+    staleFrameLimit_ = frames;
+}
+
+// micros() when ATT went low for the last readData() frame, after any wait for readDelay_.
+unsigned long Controller::frameStartedUs() const
+{
+    return frameStartedUs_;
+}
+
+// micros() when ATT went high again for the last readData() frame.
+unsigned long Controller::frameCompletedUs() const
+{
+    return frameCompletedUs_;
+}
+
+// Sticks and pressures that moved further than their threshold during the last readData(). Bits follow the data
+// layout starting from PSS_RX, see analogChannelMask().
+uint16_t Controller::analogChangeMask() const
+{
+    return analogChanged_;
+}
+
+bool Controller::analogStateChanged(uint16_t buttonId) const
+{
+    return ((analogChanged_ & analogChannelMask(buttonId)) > 0);
+}
+
+void Controller::setAnalogThreshold(byte threshold)
+{
+    memset(analogThresholds_, threshold, sizeof(analogThresholds_));
+}
+
+// A channel is reported as changed once it differs by more than threshold from the value it had when it was last
+// reported, so slow drift is still reported eventually. PSAB_* channels are ignored without PS2_PRESSURES.
+void Controller::setAnalogThreshold(uint16_t buttonId, byte threshold)
+{
+    const uint16_t channel = buttonId - firstAnalogChannel;
+    if (channel >= analogChannels) {
+        return;
+    }
+    analogThresholds_[channel] = threshold;
+}
+
 byte Controller::sendByte(byte inputByte)
 {
+    byte samples[8];
+    clockByte(inputByte, samples);
+    const byte result = sampledByte(samples, static_cast<byte>(1u << dataMask_));
+#ifdef PS2_TRACE
+    traceBuffer.record(traceTag_, inputByte, result);
+    traceTag_ &= ~TraceBuffer::frameStart;
+#endif
+    byteGap();
+
+    return result;
+}
+
+// Clocks one byte out on CMD and keeps the DAT input port as sampled for each bit, so one or several pads on that port
+// are decoded after CLK is back high. With InterruptPolicy::PerFrame beginTransfer() has disabled interrupts for the
+// whole frame, so no ISR can stretch a bit and there is no SREG to save and restore; the half bits are spun for a
+// fixed number of cycles instead.
+void Controller::clockByte(byte command, byte samples[8])
+{
+    if (interruptPolicy_ == InterruptPolicy::PerFrame) {
+        for (uint8_t i = 0; i < 8; ++i) {
+            if (getBit(command, i)) {
+                setBit(*commandOutputRegister_, commandMask_);
+            } else {
+                clearBit(*commandOutputRegister_, commandMask_);
+            }
+            clearBit(*clockOuputRegister_, clockMask_);
+            spinUs<controlDelayUs>();
+            samples[i] = *dataInputRegister_;
+            setBit(*clockOuputRegister_, clockMask_);
+        }
+        setBit(*commandOutputRegister_, commandMask_);
+        return;
+    }
+
     const uint8_t oldSreg = SREG;
-    uint8_t       result  = 0;
-    cli();
-    for (int i = 0; i < 8; ++i) {
-        if (getBit(inputByte, i)) {
+    const bool    perBit  = (interruptPolicy_ == InterruptPolicy::PerBit);
+    disableInterrupts();
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (getBit(command, i)) {
             setBit(*commandOutputRegister_, commandMask_);
         } else {
             clearBit(*commandOutputRegister_, commandMask_);
         }
         clearBit(*clockOuputRegister_, clockMask_);
 
-        SREG = oldSreg;
-        delayMicroseconds(controlDelayUs);
-        cli();
+        if (perBit) {
+            restoreInterrupts(oldSreg);
+            delayMicroseconds(controlDelayUs);
+            disableInterrupts();
+        } else {
+            delayMicroseconds(controlDelayUs);
+        }
 
-        if (getBit(*dataInputRegister_, dataMask_)) {
+        samples[i] = *dataInputRegister_;
+        setBit(*clockOuputRegister_, clockMask_);
+    }
+    setBit(*commandOutputRegister_, commandMask_);
+    restoreInterrupts(oldSreg);
+}
+
+// Pause after every byte, spun like the half bits with InterruptPolicy::PerFrame.
+void Controller::byteGap() const
+{
+    if (interruptPolicy_ == InterruptPolicy::PerFrame) {
+        spinUs<controlByteDelayUs>();
+    } else {
+        delayMicroseconds(controlByteDelayUs);
+    }
+}
+
+// The byte one pad sent on the port bit in mask.
+byte Controller::sampledByte(const byte samples[8], byte mask)
+{
+    byte result = 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (samples[i] & mask) {
             setBit(result, i);
         }
-        setBit(*clockOuputRegister_, clockMask_);
     }
+    return result;
+}
+
+// Selects the controller. Returns SREG to pass to endTransfer(), with InterruptPolicy::PerFrame interrupts stay
+// disabled until then.
+uint8_t Controller::beginTransfer(TraceSource source)
+{
+#ifdef PS2_TRACE
+    traceTag_ = static_cast<uint8_t>(source) | TraceBuffer::frameStart;
+#else
+    (void)source;
+#endif
+    const uint8_t oldSreg = SREG;
+    disableInterrupts();
     setBit(*commandOutputRegister_, commandMask_);
-    SREG = oldSreg;
+    setBit(*clockOuputRegister_, clockMask_);
+    clearBit(*attentionOutputRegister_, attentionMask_); // low enable joystick
+    if (interruptPolicy_ != InterruptPolicy::PerFrame) {
+        restoreInterrupts(oldSreg);
+    }
     delayMicroseconds(controlByteDelayUs);
 
-    return result;
+    return oldSreg;
+}
+
+void Controller::endTransfer(uint8_t oldSreg)
+{
+    disableInterrupts();
+    setBit(*attentionOutputRegister_, attentionMask_); // HI disable joystick
+    restoreInterrupts(oldSreg);
+}
+
+void Controller::disableInterrupts()
+{
+#ifdef PS2_MEASURE_INTERRUPTS_OFF
+    if (getBit(SREG, SREG_I)) { // Only the outermost window is measured.
+        interruptsOffTimestampUs_ = micros();
+    }
+#endif
+    cli();
+}
+
+void Controller::restoreInterrupts(uint8_t oldSreg)
+{
+#ifdef PS2_MEASURE_INTERRUPTS_OFF
+    if (getBit(oldSreg, SREG_I)) {
+        const unsigned long interruptsOffUs = micros() - interruptsOffTimestampUs_;
+        if (interruptsOffUs > maxInterruptsOffUs_) {
+            maxInterruptsOffUs_ = interruptsOffUs;
+        }
+    }
+#endif
+    SREG = oldSreg;
 }
 
 void Controller::readData()
@@ -184,10 +597,44 @@ void Controller::readData()
 
 void Controller::readData(boolean motor1, byte motor2)
 {
-    uint8_t old_sreg = SREG;
+    prepareRead();
+
+    frameStartedUs_       = micros();
+    const uint8_t oldSreg = beginTransfer(TraceSource::Poll);
+    // Send the command to send button and joystick data, the frame length follows from the mode in byte 1.
+    byte command[baseDataSize];
+    pollCommand(motor1, motor2, command);
+    uint8_t size = baseDataSize;
+    for (uint8_t i = 0; i < size; ++i) {
+        data_[i] = sendByte(i < baseDataSize ? command[i] : 0);
+        if (i == 1) {
+            size = pollFrameSize(data_[1]);
+        }
+    }
+    endTransfer(oldSreg);
+    fillMissingSticks();
+    frameCompletedUs_ = micros();
+
+    finishRead();
+}
+
+// For poll frames that were transferred by other means than readData(), e.g. by SpiPoller. Longer frames are cut to
+// the 21 bytes of a pressure mode reply.
+void Controller::decodeFrame(const byte frame[], uint8_t size, unsigned long startedUs)
+{
+    previousButtonsState_ = buttonsState_;
+    memcpy(data_, frame, (size < sizeof(data_) ? size : sizeof(data_)));
+    frameStartedUs_   = startedUs;
+    frameCompletedUs_ = micros();
+    finishRead();
+}
 
+// Everything readData() does before the frame: reconfiguration after a long pause and the minimum read period.
+void Controller::prepareRead()
+{
     const unsigned long msSinceLastReading = millis() - lastDataReadTimestamp_;
-    if (msSinceLastReading > readPeriodUntilReconfiguration) { // Waited too long, reconfiguration needed.
+    if (config::reconfiguration
+        && msSinceLastReading > readPeriodUntilReconfiguration) { // Waited too long, reconfiguration needed.
         reconfigureController();
     }
     if (msSinceLastReading < readDelay_) { // Waited too short.
@@ -195,92 +642,176 @@ void Controller::readData(boolean motor1, byte motor2)
     }
 
     previousButtonsState_ = buttonsState_;
+}
 
-    cli();
-    setBit(*commandOutputRegister_, commandMask_);
-    setBit(*clockOuputRegister_, clockMask_);
-    clearBit(*attentionOutputRegister_, attentionMask_); // low enable joystick
-    SREG = old_sreg;
-    delayMicroseconds(controlByteDelayUs);
+// Everything readData() does after data_ has been filled.
+void Controller::finishRead()
+{
+    if (!checkLink()) {
+        memcpy(data_, lastGoodData_, sizeof(data_));
+    }
+    buttonsState_          = *(decltype(buttonsState_)*)(data_ + 3); // store as one value for multiple functions
+    lastDataReadTimestamp_ = millis();
+    updateAnalogChanges(config::pressures && data_[1] == correctMode3 ? analogChannels : stickChannels);
+    updatePressureMasks();
+    if (history_) {
+        history_->record(*this, lastDataReadTimestamp_);
+    }
+}
 
-    // Send the command to send button and joystick data;
-    if (motor2) {
-        motor2 = map(motor2, 0, 0xFF, 0x40, 0xFF); // Values lower than 0x40 will not trigger motor.
+void Controller::readData(Rumble &rumble)
+{
+    rumble.update(millis());
+    readData(rumble.smallMotor(), rumble.largeMotor());
+}
+
+void Controller::sendCommandString(const byte string[], uint8_t size)
+{
+    const uint8_t oldSreg = beginTransfer(TraceSource::Command);
+    for (uint8_t i = 0; i < size; ++i) {
+        sendByte(string[i]);
     }
-    byte command[baseDataSize] = { 0x01, 0x42, 0, motor1, motor2, 0, 0, 0, 0 };
+    endTransfer(oldSreg);
+    delay(readDelay_);
+}
 
-    for (uint8_t i = 0; i < baseDataSize; ++i) {
-        data_[i] = sendByte(command[i]);
+// Classifies the frame in data_ and keeps the link statistics. Returns false when data_ has to be replaced by the last
+// good frame. Until configure() has succeeded every frame is taken as it is. A frame in another mode than the pad was
+// configured for, e.g. from a wireless pad that lost its pairing or a pad stuck in configuration mode, counts as a
+// dropout; the pad is reconfigured right away instead of waiting for readPeriodUntilReconfiguration, and again every
+// readPeriodUntilReconfiguration while it stays in that mode. When the link comes back in the configured mode, the
+// next good frame is all it takes.
+bool Controller::checkLink()
+{
+    if (expectedMode_ == 0) {
+        return true;
     }
-    if (data_[1] == 0x79) { // if controller is in full data return mode, get the rest of data
-        for (uint8_t i = 0; i < auxDataSize; ++i) {
-            data_[i + 9] = sendByte(0);
+    const unsigned long now       = millis();
+    FrameStatus         status    = FrameStatus::Valid;
+    bool                wrongMode = false;
+    ++linkStats_.frames;
+    if (data_[1] == 0xFF || data_[2] != frameHeader) {
+        status = FrameStatus::Dropout;
+        ++linkStats_.droppedFrames;
+    } else if (data_[1] != expectedMode_) {
+        status    = FrameStatus::Dropout;
+        wrongMode = true;
+        ++linkStats_.droppedFrames;
+    } else if (controllerType_ == ControllerType::WirelessDualShock && staleFrameLimit_ > 0) {
+        const uint16_t checksum = frameChecksum();
+        if (checksum != lastChecksum_) {
+            identicalFrames_ = 0;
+        } else if (identicalFrames_ < staleFrameLimit_) {
+            ++identicalFrames_;
+        }
+        lastChecksum_ = checksum;
+        if (identicalFrames_ == staleFrameLimit_) {
+            status = FrameStatus::Stale;
+            ++linkStats_.staleFrames;
         }
     }
 
-    cli();
-    setBit(*attentionOutputRegister_, attentionMask_); // HI disable joystick
-    SREG = old_sreg;
-
-#ifdef PS2X_COM_DEBUG
-    Serial.println("OUT:IN");
-    for (int i = 0; i < 9; i++) {
-        Serial.print(dword[i], HEX);
-        Serial.print(":");
-        Serial.print(PS2data[i], HEX);
-        Serial.print(" ");
-    }
-    for (int i = 0; i < 12; i++) {
-        Serial.print(dword2[i], HEX);
-        Serial.print(":");
-        Serial.print(PS2data[i + 9], HEX);
-        Serial.print(" ");
-    }
-    Serial.println("");
-#endif
+    if (status != FrameStatus::Valid) {
+        if (frameStatus_ == FrameStatus::Valid) {
+            ++linkStats_.dropouts;
+            linkLostMs_ = now;
+        }
+        if (config::reconfiguration && wrongMode && now - lastReconfigurationMs_ >= readPeriodUntilReconfiguration) {
+            reconfigureController();
+            lastReconfigurationMs_ = now;
+        }
+        frameStatus_ = status;
+        return (status == FrameStatus::Stale); // A stale frame is the last good one anyway.
+    }
 
-    buttonsState_          = *(decltype(buttonsState_)*)(data_ + 3); // store as one value for multiple functions
-    lastDataReadTimestamp_ = millis();
+    if (frameStatus_ != FrameStatus::Valid) {
+        if (now - linkLostMs_ > linkStats_.longestDropoutMs) {
+            linkStats_.longestDropoutMs = now - linkLostMs_;
+        }
+        if (static_cast<long>(lastReconfigurationMs_ - linkLostMs_) >= 0) {
+            ++linkStats_.reconfigurations;
+        } else {
+            ++linkStats_.resyncs;
+        }
+    }
+    frameStatus_      = FrameStatus::Valid;
+    lastValidFrameMs_ = now;
+    memcpy(lastGoodData_, data_, sizeof(lastGoodData_));
+    return true;
 }
 
-void Controller::sendCommandString(const byte string[], uint8_t size)
+// Rotate-xor over the button and analog bytes, enough to tell repeated frames apart.
+uint16_t Controller::frameChecksum() const
 {
-    const uint8_t oldSreg = SREG;
-#ifdef PS2X_COM_DEBUG
-    byte temp[size];
-    cli();                                               // *** KJE *** disable for now
-    clearBit(*attentionOutputRegister_, attentionMask_); // low enable joystick
-    SREG = oldSreg;                                      // *** *** KJE *** *** Interrupts may be enabled again
-
-    for (int y = 0; y < size; ++y)
-        temp[y] = _gamepad_shiftinout(string[y]);
+    const uint8_t size     = (config::pressures && data_[1] == correctMode3 ? frameSize : baseDataSize);
+    uint16_t      checksum = 0;
+    for (uint8_t i = 3; i < size; ++i) {
+        checksum = static_cast<uint16_t>(((checksum << 1) | (checksum >> 15)) ^ data_[i]);
+    }
+    return checksum;
+}
 
-    cli();                                          // *** KJE *** disable for now
-    SET(*attentionOutputRegister_, attentionMask_); // high disable joystick
-    SREG = oldSreg;                                 // *** *** KJE *** *** Interrupts may be enabled again
-    delay(readDelay_);                              // wait a few
+// Compares four channels at a time and only looks at single bytes of words that differ. Mostly idle sticks and
+// released pressure buttons therefore cost one word compare per four channels.
+void Controller::updateAnalogChanges(uint8_t channels)
+{
+    const byte *values = data_ + firstAnalogChannel;
+    analogChanged_     = 0;
+    for (uint8_t word = 0; word < channels; word += sizeof(uint32_t)) {
+        uint32_t valuesWord;
+        uint32_t referenceWord;
+        memcpy(&valuesWord, values + word, sizeof(valuesWord));
+        memcpy(&referenceWord, analogReference_ + word, sizeof(referenceWord));
+        if (valuesWord == referenceWord) {
+            continue;
+        }
 
-    Serial.println("OUT:IN Configure");
-    for (uint8_t i = 0; i < size; ++i) {
-        Serial.print(string[i], HEX);
-        Serial.print(":");
-        Serial.print(temp[i], HEX);
-        Serial.print(" ");
+        for (uint8_t i = word; i < word + sizeof(uint32_t); ++i) {
+            const byte delta = (values[i] > analogReference_[i] ? values[i] - analogReference_[i]
+                                                                : analogReference_[i] - values[i]);
+            if (delta > analogThresholds_[i]) {
+                setBit(analogChanged_, i);
+                analogReference_[i] = values[i];
+            }
+        }
     }
-    Serial.println("");
+}
 
+byte Controller::scaleMotor(byte level)
+{
+#if PS2_RUMBLE
+    return pgm_read_byte(&motorScaleTable.values[level]);
 #else
-    cli();
-    clearBit(*attentionOutputRegister_, attentionMask_); // low enable joystick
-    SREG = oldSreg;
-    for (uint8_t i = 0; i < size; ++i) {
-        sendByte(string[i]);
-    }
+    (void)level;
+    return 0;
+#endif
+}
 
-    cli();
-    setBit(*attentionOutputRegister_, attentionMask_); // high disable joystick
-    SREG = oldSreg;
-    delay(readDelay_);
+// All twelve pressures are compared against the four threshold rows four bytes at a time, see lanesAtLeast().
+void Controller::updatePressureMasks()
+{
+#if PS2_PRESSURES
+    const uint16_t oldSoft = softPressureMask_;
+    const uint16_t oldHard = hardPressureMask_;
+    if (data_[1] != correctMode3) {
+        softPressureMask_ = 0;
+        hardPressureMask_ = 0;
+    } else {
+        uint16_t atLeast[4] = {};
+        for (uint8_t word = 0; word < auxDataSize; word += sizeof(uint32_t)) {
+            uint32_t values;
+            memcpy(&values, data_ + baseDataSize + word, sizeof(values));
+            for (uint8_t level = 0; level < 4; ++level) {
+                uint32_t thresholds;
+                memcpy(&thresholds, pressureThresholds_[level] + word, sizeof(thresholds));
+                atLeast[level] |= static_cast<uint16_t>(laneMask(lanesAtLeast(values, thresholds)) << word);
+            }
+        }
+        softPressureMask_ = atLeast[SoftPress] | (oldSoft & atLeast[SoftRelease]);
+        hardPressureMask_ = atLeast[HardPress] | (oldHard & atLeast[HardRelease]);
+    }
+    softPressEdges_ = softPressureMask_ & ~oldSoft;
+    hardPressEdges_ = hardPressureMask_ & ~oldHard;
 #endif
 }
 
@@ -299,34 +830,109 @@ ControllerType Controller::type() const
     return controllerType_;
 }
 
+Capabilities Controller::capabilities() const
+{
+    return capabilities_;
+}
+
+// Bytes clocked per readData() in the current mode.
+uint8_t Controller::frameBytes() const
+{
+    return pollFrameSize(data_[1]);
+}
+
+// Poll frame length for the mode byte of the reply. The aux bytes of pressure mode are only read with PS2_PRESSURES.
+uint8_t Controller::pollFrameSize(byte mode)
+{
+    if (mode == correctMode1) {
+        return digitalDataSize;
+    }
+    return (config::pressures && mode == correctMode3 ? frameSize : baseDataSize);
+}
+
+// The poll command (0x42) with the motor values, both 0 without PS2_RUMBLE.
+void Controller::pollCommand(bool motor1, byte motor2, byte command[])
+{
+    const byte poll[baseDataSize] = { 0x01, 0x42, 0, (config::rumble && motor1), scaleMotor(motor2), 0, 0, 0, 0 };
+    memcpy(command, poll, baseDataSize);
+}
+
+// Digital mode frames end after the buttons, the bytes of the missing sticks read as an idle bus would.
+void Controller::fillMissingSticks()
+{
+    if (data_[1] == correctMode1) {
+        memset(data_ + digitalDataSize, 0xFF, baseDataSize - digitalDataSize);
+    }
+}
+
 void Controller::enableRumble()
 {
+    if constexpr (!config::rumble) {
+        return;
+    }
     sendCommandString(commands::startConfiguration, sizeof(commands::startConfiguration));
     sendCommandString(commands::enableRumble, sizeof(commands::enableRumble));
     sendCommandString(commands::stopConfiguration, sizeof(commands::stopConfiguration));
     enableRumble_ = true;
+    adoptMode(expectedMode_); // The mode stays, the frame after the config run becomes the last good one.
 }
 
 bool Controller::enablePressures()
 {
+    if constexpr (!config::pressures) {
+        return false;
+    }
     sendCommandString(commands::startConfiguration, sizeof(commands::startConfiguration));
     sendCommandString(commands::setAuxData, sizeof(commands::setAuxData));
     sendCommandString(commands::stopConfiguration, sizeof(commands::stopConfiguration));
 
-    readData();
-    // readData();
-
-    if (data_[1] != 0x79)
+    if (!adoptMode(correctMode3)) {
         return false;
-
+    }
     pressureMode_ = true;
     return true;
 }
 
+// Reads the first frame after a config run outside configure() without the link check, which would count the new
+// mode as a wrong-mode dropout. When the pad answers in mode, checkLink() expects that mode and frame from now on,
+// otherwise the previous ones stay.
+bool Controller::adoptMode(byte mode)
+{
+    const byte previousMode = expectedMode_;
+    expectedMode_           = 0;
+    readData();
+    if (mode == 0 || data_[1] != mode) {
+        expectedMode_ = previousMode;
+        return false;
+    }
+    expectedMode_ = mode;
+    memcpy(lastGoodData_, data_, sizeof(lastGoodData_));
+    return true;
+}
+
+void Controller::setInterruptPolicy(InterruptPolicy policy)
+{
+    interruptPolicy_ = policy;
+}
+
+// Records every following frame in history, nullptr detaches it. The controller doesn't own the history.
+void Controller::attachHistory(SnapshotHistory *history)
+{
+    history_ = history;
+}
+
+#ifdef PS2_MEASURE_INTERRUPTS_OFF
+unsigned long Controller::maxInterruptsOffUs() const
+{
+    return maxInterruptsOffUs_;
+}
+#endif
+
 void Controller::reconfigureController()
 {
     sendCommandString(commands::startConfiguration, sizeof(commands::startConfiguration));
-    sendCommandString(commands::setMode, sizeof(commands::setMode));
+    sendCommandString((expectedMode_ == correctMode1 ? commands::setDigitalMode : commands::setMode),
+                      sizeof(commands::setMode));
     if (enableRumble_) {
         sendCommandString(commands::enableRumble, sizeof(commands::enableRumble));
     }
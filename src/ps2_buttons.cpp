@@ -0,0 +1,92 @@
+#include "ps2_buttons.hpp"
+#include "ps2.hpp"
+
+namespace ps2 {
+
+namespace {
+
+// Index of the lowest set bit, mask must not be 0.
+uint8_t lowestBit(uint16_t mask)
+{
+    return static_cast<uint8_t>(__builtin_ctz(mask));
+}
+
+} // namespace
+
+void ButtonDispatcher::on(uint16_t buttons, ButtonEvent event, ButtonHandler handler)
+{
+    if (handler == nullptr) {
+        clear(buttons, event);
+        return;
+    }
+    const uint8_t eventIndex = static_cast<uint8_t>(event);
+    registered_[eventIndex] |= buttons;
+    for (uint16_t mask = buttons; mask != 0; mask &= mask - 1) {
+        handlers_[eventIndex][lowestBit(mask)] = handler;
+    }
+}
+
+void ButtonDispatcher::clear(uint16_t buttons, ButtonEvent event)
+{
+    const uint8_t eventIndex = static_cast<uint8_t>(event);
+    registered_[eventIndex] &= ~buttons;
+    for (uint16_t mask = buttons; mask != 0; mask &= mask - 1) {
+        handlers_[eventIndex][lowestBit(mask)] = nullptr;
+    }
+    if (event == ButtonEvent::Hold) {
+        holdPending_ &= ~buttons;
+    }
+}
+
+void ButtonDispatcher::setHoldDelay(uint16_t ms)
+{
+    holdDelayMs_ = ms;
+}
+
+void ButtonDispatcher::dispatch(const Controller &controller)
+{
+    dispatch(controller, millis());
+}
+
+// Call once after every readData(). Releases are reported before presses so a handler never sees a button pressed
+// twice in a row.
+void ButtonDispatcher::dispatch(const Controller &controller, unsigned long timestampMs)
+{
+    const uint16_t changed = controller.changedButtons();
+    const uint16_t now     = static_cast<uint16_t>(timestampMs);
+    if (changed != 0) {
+        const uint16_t pressed  = changed & controller.pressedButtons();
+        const uint16_t released = changed & ~pressed;
+        const uint16_t holds    = pressed & registered_[static_cast<uint8_t>(ButtonEvent::Hold)];
+
+        holdPending_ &= ~released;
+        for (uint16_t mask = holds; mask != 0; mask &= mask - 1) {
+            pressedAtMs_[lowestBit(mask)] = now;
+        }
+        holdPending_ |= holds;
+        call(ButtonEvent::Release, released);
+        call(ButtonEvent::Press, pressed);
+    }
+
+    // Only buttons that are still held and waiting for their hold event are visited.
+    uint16_t expired = 0;
+    for (uint16_t mask = holdPending_; mask != 0; mask &= mask - 1) {
+        const uint8_t bit = lowestBit(mask);
+        if (static_cast<uint16_t>(now - pressedAtMs_[bit]) >= holdDelayMs_) {
+            expired |= static_cast<uint16_t>(1u << bit);
+        }
+    }
+    holdPending_ &= ~expired;
+    call(ButtonEvent::Hold, expired);
+}
+
+void ButtonDispatcher::call(ButtonEvent event, uint16_t buttons)
+{
+    const uint8_t eventIndex = static_cast<uint8_t>(event);
+    for (uint16_t mask = buttons & registered_[eventIndex]; mask != 0; mask &= mask - 1) {
+        const uint8_t bit = lowestBit(mask);
+        handlers_[eventIndex][bit](static_cast<uint16_t>(1u << bit));
+    }
+}
+
+} // namespace ps2
@@ -0,0 +1,49 @@
+#include "ps2_cache.hpp"
+
+namespace ps2 {
+
+FrameCache::FrameCache(Controller &controller) : controller_ { controller }
+{
+}
+
+// A max age of 0 always polls.
+const Controller &FrameCache::read(unsigned long maxAgeMs)
+{
+    if (fresh(maxAgeMs)) {
+        ++hits_;
+    } else {
+        ++misses_;
+        controller_.readData(smallMotor_, largeMotor_);
+    }
+    return controller_;
+}
+
+bool FrameCache::fresh(unsigned long maxAgeMs) const
+{
+    return (micros() - controller_.frameCompletedUs() < maxAgeMs * 1000);
+}
+
+// Motor levels sent with every poll that read() makes.
+void FrameCache::setMotors(bool smallMotor, byte largeMotor)
+{
+    smallMotor_ = smallMotor;
+    largeMotor_ = largeMotor;
+}
+
+uint32_t FrameCache::hits() const
+{
+    return hits_;
+}
+
+uint32_t FrameCache::misses() const
+{
+    return misses_;
+}
+
+void FrameCache::resetStats()
+{
+    hits_   = 0;
+    misses_ = 0;
+}
+
+} // namespace ps2
@@ -0,0 +1,59 @@
+#include "ps2_combo.hpp"
+#include "ps2.hpp"
+
+#include <avr/pgmspace.h>
+
+namespace ps2 {
+
+namespace {
+
+bool completes(uint16_t step, uint16_t pressed, uint16_t newlyPressed)
+{
+    return ((pressed & step) == step && (newlyPressed & step) != 0);
+}
+
+} // namespace
+
+// A press outside the expected step restarts the combo, possibly as its own first step. Presses that are part of the
+// expected step but don't complete it yet keep the progress, so chords can be pressed one button at a time.
+uint16_t advanceCombos(const Combo      combos[],
+                       ComboState       states[],
+                       uint16_t         count,
+                       const Controller &controller,
+                       unsigned long    timestampMs)
+{
+    const uint16_t pressed      = controller.pressedButtons();
+    const uint16_t newlyPressed = controller.changedButtons() & pressed;
+    if (newlyPressed == 0) {
+        return noCombo;
+    }
+
+    const uint16_t now     = static_cast<uint16_t>(timestampMs);
+    uint16_t       matched = noCombo;
+    for (uint16_t i = 0; i < count; ++i) {
+        const Combo   *combo  = &combos[i];
+        ComboState    &state  = states[i];
+        const uint16_t window = pgm_read_word(&combo->windowMs);
+        if (state.progress > 0 && window != 0 && static_cast<uint16_t>(now - state.lastStepMs) > window) {
+            state.progress = 0;
+        }
+
+        const uint16_t expected = pgm_read_word(&combo->steps[state.progress]);
+        if (completes(expected, pressed, newlyPressed)) {
+            ++state.progress;
+        } else if ((newlyPressed & ~expected) != 0) {
+            state.progress = (completes(pgm_read_word(&combo->steps[0]), pressed, newlyPressed) ? 1 : 0);
+        } else {
+            continue;
+        }
+        state.lastStepMs = now;
+
+        if (state.progress == pgm_read_byte(&combo->size)) {
+            state.progress = 0;
+            matched        = (matched == noCombo ? i : matched);
+        }
+    }
+    return matched;
+}
+
+} // namespace ps2
@@ -0,0 +1,294 @@
+#include "ps2_coprocessor.hpp"
+
+#include <string.h>
+
+namespace ps2 {
+
+namespace {
+
+constexpr uint8_t statusSize = registers::frameAge + 1 - registers::status;
+
+void putWord(byte *target, uint16_t value)
+{
+    target[0] = static_cast<byte>(value);
+    target[1] = static_cast<byte>(value >> 8);
+}
+
+uint16_t getWord(const byte *source)
+{
+    return static_cast<uint16_t>(source[0] | (source[1] << 8));
+}
+
+bool changeRegister(uint8_t address)
+{
+    return (address >= registers::changedButtons && address < registers::pressureMask);
+}
+
+} // namespace
+
+RegisterMap::RegisterMap()
+{
+    memset(snapshots_, 0, sizeof(snapshots_));
+    snapshots_[0][registers::id]      = registers::identifier;
+    snapshots_[0][registers::version] = registers::mapVersion;
+    memcpy(snapshots_[1], snapshots_[0], sizeof(snapshots_[0]));
+    config_[registers::pollPeriod - registers::pollPeriod]      = 16;
+    config_[registers::smallMotor - registers::pollPeriod]      = 0;
+    config_[registers::largeMotor - registers::pollPeriod]      = 0;
+    config_[registers::analogThreshold - registers::pollPeriod] = 0;
+}
+
+// Change masks accumulate until the master has read them, so a press and release between two reads is not lost. A
+// read only clears the bits of the copy it came from, minus those that changed again after that copy was published:
+// the master may have read the older copy while the previous update() was filling the other one.
+void RegisterMap::update(const Controller &controller, bool configured)
+{
+    for (uint8_t copy = 0; copy < 2; ++copy) {
+        if (changesRead_[copy]) {
+            changesRead_[copy] = false;
+            changedButtons_ &= ~(getWord(snapshots_[copy] + registers::changedButtons) & ~newButtonChanges_[copy]);
+            analogChanges_ &= ~(getWord(snapshots_[copy] + registers::analogChanges) & ~newAnalogChanges_[copy]);
+        }
+    }
+    const uint8_t  back          = published_ ^ 1;
+    const uint16_t buttonChanges = controller.changedButtons();
+    const uint16_t analogChanges = controller.analogChangeMask();
+    changedButtons_ |= buttonChanges;
+    analogChanges_ |= analogChanges;
+    newButtonChanges_[published_] |= buttonChanges;
+    newAnalogChanges_[published_] |= analogChanges;
+    newButtonChanges_[back] = 0;
+    newAnalogChanges_[back] = 0;
+
+    byte *snapshot               = snapshots_[back];
+    const unsigned long frameAge = controller.frameAgeMs();
+    snapshot[registers::status]   = static_cast<byte>(controller.frameStatus()) | (configured ? registers::configured : 0);
+    snapshot[registers::mode]     = controller.analogButtonState(1);
+    snapshot[registers::sequence] = ++sequence_;
+    putWord(snapshot + registers::buttons, controller.pressedButtons());
+    putWord(snapshot + registers::changedButtons, changedButtons_);
+    putWord(snapshot + registers::analogChanges, analogChanges_);
+    putWord(snapshot + registers::pressureMask, controller.pressureMask());
+    for (uint8_t i = 0; i < 4; ++i) {
+        snapshot[registers::sticks + i] = controller.analogButtonState(PSS_RX + i);
+    }
+    for (uint8_t i = 0; i < 12; ++i) {
+        snapshot[registers::pressures + i] = controller.analogButtonState(PSAB_PAD_RIGHT + i);
+    }
+    snapshot[registers::frameAge] = static_cast<byte>(frameAge > 0xFF ? 0xFF : frameAge);
+    published_ ^= 1;
+}
+
+void RegisterMap::select(uint8_t address)
+{
+    address_ = address;
+}
+
+// Writes outside the config registers are ignored but still advance the address.
+void RegisterMap::write(byte value)
+{
+    if (address_ >= registers::pollPeriod && address_ < registers::end) {
+        config_[address_ - registers::pollPeriod] = value;
+        configChanged_                            = true;
+    }
+    ++address_;
+}
+
+// Copies up to maxSize bytes from the selected address on and advances it, stopping at the end of the map. Safe to
+// call from the I2C request interrupt.
+uint8_t RegisterMap::readBlock(byte *out, uint8_t maxSize)
+{
+    const uint8_t copy     = published_;
+    const byte   *snapshot = snapshots_[copy];
+    uint8_t       size     = 0;
+    while (size < maxSize && address_ < registers::end) {
+        const uint8_t address = address_;
+        if (address < registers::snapshotEnd) {
+            out[size] = snapshot[address];
+        } else if (address >= registers::pollPeriod) {
+            out[size] = config_[address - registers::pollPeriod];
+        } else {
+            out[size] = 0;
+        }
+        if (changeRegister(address)) {
+            changesRead_[copy] = true;
+        }
+        ++size;
+        address_ = address + 1;
+    }
+    return size;
+}
+
+bool RegisterMap::takeConfigChange()
+{
+    const bool changed = configChanged_;
+    configChanged_     = false;
+    return changed;
+}
+
+byte RegisterMap::config(uint8_t address) const
+{
+    return config_[address - registers::pollPeriod];
+}
+
+ErrorCode Coprocessor::begin(
+    uint8_t clockPin, uint8_t commandPin, uint8_t attentionPin, uint8_t dataPin, bool pressureMode, bool enableRumble)
+{
+    const ErrorCode error = controller_.configure(clockPin, commandPin, attentionPin, dataPin, pressureMode, enableRumble);
+    configured_           = (error == ErrorCode::Success);
+    registers_.update(controller_, configured_);
+    lastPollMs_ = millis();
+    return error;
+}
+
+// Call as often as possible, polls once the poll period has passed.
+void Coprocessor::poll()
+{
+    const unsigned long now = millis();
+    if (now - lastPollMs_ < registers_.config(registers::pollPeriod)) {
+        return;
+    }
+    lastPollMs_ = now;
+    if (registers_.takeConfigChange()) {
+        controller_.setAnalogThreshold(registers_.config(registers::analogThreshold));
+    }
+    controller_.readData(registers_.config(registers::smallMotor) != 0, registers_.config(registers::largeMotor));
+    registers_.update(controller_, configured_);
+}
+
+RegisterMap &Coprocessor::registers()
+{
+    return registers_;
+}
+
+Controller &Coprocessor::controller()
+{
+    return controller_;
+}
+
+// Consumes whatever has arrived and answers complete read requests right away.
+void SerialRegisterPort::service(Stream &stream, RegisterMap &registers)
+{
+    enum State : uint8_t
+    {
+        Command,
+        Address,
+        Size,
+        Data
+    };
+
+    while (stream.available() > 0) {
+        const byte value = static_cast<byte>(stream.read());
+        switch (state_) {
+            case Command:
+                if (value == serialFrame::read || value == serialFrame::write) {
+                    command_ = value;
+                    state_   = Address;
+                }
+                break;
+            case Address:
+                registers.select(value);
+                state_ = Size;
+                break;
+            case Size:
+                remaining_ = value;
+                if (command_ == serialFrame::read) {
+                    byte block[RegisterMap::maxBlockSize];
+                    while (remaining_ > 0) {
+                        const uint8_t size = registers.readBlock(
+                            block, remaining_ < sizeof(block) ? remaining_ : static_cast<uint8_t>(sizeof(block)));
+                        if (size == 0) {
+                            break;
+                        }
+                        stream.write(block, size);
+                        remaining_ -= size;
+                    }
+                    state_ = Command;
+                } else {
+                    state_ = (remaining_ > 0 ? Data : Command);
+                }
+                break;
+            case Data:
+                registers.write(value);
+                state_ = (--remaining_ > 0 ? Data : Command);
+                break;
+        }
+    }
+}
+
+StreamLink::StreamLink(Stream &stream, unsigned long timeoutMs) : stream_ { stream }, timeoutMs_ { timeoutMs }
+{
+}
+
+bool StreamLink::readRegisters(uint8_t address, byte *out, uint8_t size)
+{
+    const byte request[] = { serialFrame::read, address, size };
+    stream_.write(request, sizeof(request));
+    const unsigned long startMs = millis();
+    for (uint8_t i = 0; i < size; ++i) {
+        while (stream_.available() == 0) {
+            if (millis() - startMs > timeoutMs_) {
+                return false;
+            }
+        }
+        out[i] = static_cast<byte>(stream_.read());
+    }
+    return true;
+}
+
+bool StreamLink::writeRegisters(uint8_t address, const byte *data, uint8_t size)
+{
+    const byte header[] = { serialFrame::write, address, size };
+    stream_.write(header, sizeof(header));
+    return (stream_.write(data, size) == size);
+}
+
+CoprocessorClient::CoprocessorClient(CoprocessorLink &link) : link_ { link }
+{
+}
+
+bool CoprocessorClient::probe()
+{
+    byte header[2];
+    return (link_.readRegisters(registers::id, header, sizeof(header)) && header[0] == registers::identifier
+            && header[1] == registers::mapVersion);
+}
+
+bool CoprocessorClient::readSnapshot(Snapshot &snapshot)
+{
+    byte block[statusSize];
+    if (!link_.readRegisters(registers::status, block, sizeof(block))) {
+        return false;
+    }
+    const byte *at          = block - registers::status;
+    snapshot.status         = static_cast<FrameStatus>(at[registers::status] & 0x03);
+    snapshot.configured     = (at[registers::status] & registers::configured);
+    snapshot.mode           = at[registers::mode];
+    snapshot.sequence       = at[registers::sequence];
+    snapshot.buttons        = getWord(at + registers::buttons);
+    snapshot.changedButtons = getWord(at + registers::changedButtons);
+    snapshot.analogChanges  = getWord(at + registers::analogChanges);
+    snapshot.pressureMask   = getWord(at + registers::pressureMask);
+    memcpy(snapshot.sticks, at + registers::sticks, sizeof(snapshot.sticks));
+    memcpy(snapshot.pressures, at + registers::pressures, sizeof(snapshot.pressures));
+    snapshot.frameAgeMs = at[registers::frameAge];
+    return true;
+}
+
+bool CoprocessorClient::setPollPeriod(uint8_t ms)
+{
+    return link_.writeRegisters(registers::pollPeriod, &ms, 1);
+}
+
+bool CoprocessorClient::setMotors(bool smallMotor, byte largeMotor)
+{
+    const byte motors[] = { static_cast<byte>(smallMotor ? 1 : 0), largeMotor };
+    return link_.writeRegisters(registers::smallMotor, motors, sizeof(motors));
+}
+
+bool CoprocessorClient::setAnalogThreshold(byte threshold)
+{
+    return link_.writeRegisters(registers::analogThreshold, &threshold, 1);
+}
+
+} // namespace ps2
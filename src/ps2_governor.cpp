@@ -0,0 +1,55 @@
+#include "ps2_governor.hpp"
+
+namespace ps2 {
+
+// Periods are clamped to minPeriodMs..maxIdlePeriodMs, a zero period could never double back to the idle period.
+void PollGovernor::setPeriods(uint16_t activeMs, uint16_t idleMs)
+{
+    activeMs        = (activeMs > minPeriodMs ? activeMs : minPeriodMs);
+    idleMs          = (idleMs > minPeriodMs ? idleMs : minPeriodMs);
+    idlePeriodMs_   = (idleMs < maxIdlePeriodMs ? idleMs : maxIdlePeriodMs);
+    activePeriodMs_ = (activeMs < idlePeriodMs_ ? activeMs : idlePeriodMs_);
+    periodMs_       = activePeriodMs_;
+}
+
+void PollGovernor::setQuietTime(uint16_t ms)
+{
+    quietMs_ = ms;
+}
+
+bool PollGovernor::due() const
+{
+    return due(millis());
+}
+
+bool PollGovernor::due(unsigned long timestampMs) const
+{
+    return (!polled_ || timestampMs - lastPollMs_ >= periodMs_);
+}
+
+void PollGovernor::update(const Controller &controller)
+{
+    update(controller, millis());
+}
+
+// Call after every readData(). The period only grows once per poll, so a burst right after a long idle spell waits
+// at most one idle period.
+void PollGovernor::update(const Controller &controller, unsigned long timestampMs)
+{
+    polled_     = true;
+    lastPollMs_ = timestampMs;
+    if (controller.buttonsStateChanged() || controller.pressedButtons() != 0
+        || (controller.analogChangeMask() & stickMask)) {
+        lastActivityMs_ = timestampMs;
+        periodMs_       = activePeriodMs_;
+    } else if (timestampMs - lastActivityMs_ >= quietMs_ && periodMs_ < idlePeriodMs_) {
+        periodMs_ = (periodMs_ * 2u < idlePeriodMs_ ? periodMs_ * 2u : idlePeriodMs_);
+    }
+}
+
+uint16_t PollGovernor::periodMs() const
+{
+    return periodMs_;
+}
+
+} // namespace ps2
@@ -0,0 +1,69 @@
+#include "ps2_group.hpp"
+
+namespace ps2 {
+
+bool ControllerGroup::add(Controller &controller)
+{
+    if (count_ == maxGroupControllers) {
+        return false;
+    }
+    controllers_[count_++] = &controller;
+    return true;
+}
+
+uint8_t ControllerGroup::size() const
+{
+    return count_;
+}
+
+// One readData() per controller, back to back, then publish(). The batch takes as long as its frames, controllers
+// sharing CLK, CMD and ATT can be read faster with LockstepGroup::readData() followed by publish().
+void ControllerGroup::poll()
+{
+    for (uint8_t i = 0; i < count_; ++i) {
+        controllers_[i]->readData();
+    }
+    publish();
+}
+
+// Takes the last frame of every controller, however it was read.
+void ControllerGroup::publish()
+{
+    GroupSnapshot &snapshot = snapshots_[published_ ^ 1];
+    snapshot.sequence       = ++sequence_;
+    snapshot.count          = count_;
+    snapshot.validMask      = 0;
+    snapshot.startedUs      = 0;
+    snapshot.completedUs    = 0;
+    for (uint8_t i = 0; i < count_; ++i) {
+        const Controller   &controller  = *controllers_[i];
+        const unsigned long startedUs   = controller.frameStartedUs();
+        const unsigned long completedUs = controller.frameCompletedUs();
+        if (i == 0 || static_cast<long>(startedUs - snapshot.startedUs) < 0) {
+            snapshot.startedUs = startedUs;
+        }
+        if (i == 0 || static_cast<long>(completedUs - snapshot.completedUs) > 0) {
+            snapshot.completedUs = completedUs;
+        }
+        snapshot.validMask |= (controller.frameStatus() == FrameStatus::Valid ? 1u << i : 0);
+        snapshot.buttons[i]        = controller.pressedButtons();
+        snapshot.changedButtons[i] = controller.changedButtons();
+        for (uint8_t stick = 0; stick < 4; ++stick) {
+            snapshot.sticks[stick][i] = controller.analogButtonState(PSS_RX + stick);
+        }
+    }
+    published_ ^= 1;
+}
+
+// Stays unchanged until the publish after next.
+const GroupSnapshot &ControllerGroup::snapshot() const
+{
+    return snapshots_[published_];
+}
+
+uint16_t ControllerGroup::sequence() const
+{
+    return sequence_;
+}
+
+} // namespace ps2
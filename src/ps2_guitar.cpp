@@ -0,0 +1,115 @@
+#include "ps2_guitar.hpp"
+
+namespace ps2 {
+
+static_assert((PSG_GREEN_FRET >> 9) == lanes::green && (PSG_RED_FRET >> 12) == lanes::red
+                  && (PSG_YELLOW_FRET >> 10) == lanes::yellow && (PSG_BLUE_FRET >> 11) == lanes::blue
+                  && (PSG_ORANGE_FRET >> 11) == lanes::orange,
+              "laneMask() shifts");
+
+void GuitarDecoder::reset()
+{
+    primed_  = false;
+    head_    = 0;
+    count_   = 0;
+    dropped_ = 0;
+}
+
+// Call after every readData(). The pad latches the buttons when their first byte, byte 3 of the frame, starts.
+void GuitarDecoder::update(const Controller &controller)
+{
+    if (!config::guitarHero || controller.frameStatus() != FrameStatus::Valid) {
+        return;
+    }
+    const unsigned long startedUs  = controller.frameStartedUs();
+    const unsigned long transferUs = controller.frameCompletedUs() - startedUs;
+    update(controller.pressedButtons(), controller.analogButtonState(PSG_WHAMMY_BAR),
+           startedUs + transferUs * buttonsByte / controller.frameBytes());
+}
+
+// A strum bit that is set now and wasn't in the previous sample queues one event. The first sample only sets the
+// state, a strum already held there has no earlier poll to bound it.
+void GuitarDecoder::update(uint16_t pressedButtons, byte whammy, unsigned long sampledUs)
+{
+    if constexpr (!config::guitarHero) {
+        return;
+    }
+    const uint16_t pressedNow = pressedButtons & ~lastPressed_;
+    lanes_                    = laneMask(pressedButtons);
+    whammy_                   = whammy;
+    if (primed_) {
+        const unsigned long gapUs = sampledUs - lastSampleUs_;
+        if (pressedNow & PSG_UP_STRUM) {
+            push(Strum::Up, gapUs);
+        }
+        if (pressedNow & PSG_DOWN_STRUM) {
+            push(Strum::Down, gapUs);
+        }
+    }
+    lastPressed_  = pressedButtons;
+    lastSampleUs_ = sampledUs;
+    primed_       = true;
+}
+
+uint8_t GuitarDecoder::lanes() const
+{
+    return lanes_;
+}
+
+// Raw byte, its rest position differs between guitar models.
+byte GuitarDecoder::whammy() const
+{
+    return whammy_;
+}
+
+bool GuitarDecoder::starPower() const
+{
+    return (lastPressed_ & PSG_STAR_POWER);
+}
+
+// Oldest first.
+bool GuitarDecoder::takeStrum(StrumEvent &event)
+{
+    if (count_ == 0) {
+        return false;
+    }
+    event = queue_[head_];
+    head_ = (head_ + 1) % queueSize;
+    --count_;
+    return true;
+}
+
+uint8_t GuitarDecoder::pendingStrums() const
+{
+    return count_;
+}
+
+// Strums lost because the queue was full, since reset().
+uint16_t GuitarDecoder::droppedStrums() const
+{
+    return dropped_;
+}
+
+// PSG_* frets to lanes::* bits without branches: every fret bit moves down by a fixed amount.
+uint8_t GuitarDecoder::laneMask(uint16_t pressedButtons)
+{
+    return static_cast<uint8_t>(((pressedButtons >> 9) & lanes::green) | ((pressedButtons >> 12) & lanes::red)
+                                | ((pressedButtons >> 10) & lanes::yellow) | ((pressedButtons >> 11) & lanes::blue)
+                                | ((pressedButtons >> 11) & lanes::orange));
+}
+
+void GuitarDecoder::push(Strum direction, unsigned long gapUs)
+{
+    if (count_ == queueSize) {
+        ++dropped_;
+        return;
+    }
+    StrumEvent &event = queue_[(head_ + count_) % queueSize];
+    event.direction   = direction;
+    event.lanes       = lanes_;
+    event.windowUs    = static_cast<uint16_t>(gapUs < 0xFFFF ? gapUs : 0xFFFF);
+    event.timestampUs = lastSampleUs_ + gapUs / 2;
+    ++count_;
+}
+
+} // namespace ps2
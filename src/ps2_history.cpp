@@ -0,0 +1,98 @@
+#include "ps2_history.hpp"
+
+#include "ps2.hpp"
+
+#include <string.h>
+
+namespace ps2 {
+
+// Presses are the buttons that are down now and were not in the previous snapshot, so a frame without presses only
+// writes one snapshot.
+void SnapshotHistory::record(const Controller &controller, unsigned long timestampMs)
+{
+    const uint16_t previous = (size_ > 0 ? snapshots_[newest_].buttons : 0);
+    newest_                 = (size_ > 0 ? (newest_ + 1) % capacity : 0);
+    size_                   = (size_ < capacity ? size_ + 1 : capacity);
+
+    HistorySnapshot &snapshot = snapshots_[newest_];
+    snapshot.timestampMs      = timestampMs;
+    snapshot.buttons          = controller.pressedButtons();
+    for (uint8_t i = 0; i < sizeof(snapshot.sticks); ++i) {
+        snapshot.sticks[i] = controller.analogButtonState(PSS_RX + i);
+    }
+
+    uint16_t presses = snapshot.buttons & ~previous;
+    for (uint8_t index = 0; presses != 0; ++index, presses >>= 1) {
+        if (presses & 1) {
+            unsigned long *times = pressTimesMs_[index];
+            memmove(times + 1, times, (tapMemory - 1) * sizeof(times[0]));
+            times[0]            = timestampMs;
+            pressCounts_[index] = (pressCounts_[index] < tapMemory ? pressCounts_[index] + 1 : tapMemory);
+        }
+    }
+}
+
+void SnapshotHistory::reset()
+{
+    memset(pressCounts_, 0, sizeof(pressCounts_));
+    newest_ = 0;
+    size_   = 0;
+}
+
+uint8_t SnapshotHistory::size() const
+{
+    return size_;
+}
+
+// Frames further back than size() - 1 return the oldest one.
+const HistorySnapshot &SnapshotHistory::snapshot(uint8_t framesAgo) const
+{
+    framesAgo = (framesAgo < size_ ? framesAgo : (size_ > 0 ? size_ - 1 : 0));
+    return snapshots_[(newest_ + capacity - framesAgo) % capacity];
+}
+
+// Time from the frame that pressed a PSB_* button to the newest frame, 0 if it isn't pressed.
+unsigned long SnapshotHistory::heldMs(uint16_t button) const
+{
+    const HistorySnapshot &newest = snapshot(0);
+    if (size_ == 0 || !(newest.buttons & button)) {
+        return 0;
+    }
+    return newest.timestampMs - pressTimesMs_[buttonIndex(button)][0];
+}
+
+// Presses of a PSB_* button within windowMs before the newest frame, including the one in it, at most tapMemory.
+uint8_t SnapshotHistory::taps(uint16_t button, unsigned long windowMs) const
+{
+    const uint8_t       index = buttonIndex(button);
+    const unsigned long now   = snapshot(0).timestampMs;
+    uint8_t             count = 0;
+    while (count < pressCounts_[index] && now - pressTimesMs_[index][count] < windowMs) {
+        ++count;
+    }
+    return count;
+}
+
+// Change of a PSS_* value from the frame that many frames ago to the newest one.
+int16_t SnapshotHistory::stickDelta(uint8_t stickId, uint8_t frames) const
+{
+    const uint8_t channel = stickId - PSS_RX;
+    return static_cast<int16_t>(snapshot(0).sticks[channel] - snapshot(frames).sticks[channel]);
+}
+
+// Time covered by stickDelta() over the same frames, to turn it into a velocity.
+unsigned long SnapshotHistory::spanMs(uint8_t frames) const
+{
+    return snapshot(0).timestampMs - snapshot(frames).timestampMs;
+}
+
+uint8_t SnapshotHistory::buttonIndex(uint16_t button)
+{
+    uint8_t index = 0;
+    while (index < buttonCount - 1 && !(button & (1u << index))) {
+        ++index;
+    }
+    return index;
+}
+
+} // namespace ps2
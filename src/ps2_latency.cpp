@@ -0,0 +1,132 @@
+#include "ps2_latency.hpp"
+#include "ps2.hpp"
+
+namespace ps2 {
+
+// Once count() reaches maxCount the buckets stay as they are, so the percentiles keep describing those samples
+// instead of wrapping around. The maximum is still tracked.
+void LatencyHistogram::add(unsigned long us)
+{
+    if (us > maximumUs_) {
+        maximumUs_ = us;
+    }
+    if (count_ == maxCount) {
+        return;
+    }
+    const unsigned long bucket = us / bucketWidthUs_;
+    ++buckets_[bucket < bucketCount ? bucket : bucketCount - 1];
+    ++count_;
+}
+
+void LatencyHistogram::reset()
+{
+    memset(buckets_, 0, sizeof(buckets_));
+    count_     = 0;
+    maximumUs_ = 0;
+}
+
+void LatencyHistogram::setBucketWidth(uint16_t us)
+{
+    bucketWidthUs_ = (us > 0 ? us : 1);
+    reset();
+}
+
+uint16_t LatencyHistogram::count() const
+{
+    return count_;
+}
+
+unsigned long LatencyHistogram::percentile(uint8_t percent) const
+{
+    const unsigned long rank       = (static_cast<unsigned long>(count_) * percent + 99) / 100;
+    unsigned long       cumulative = 0;
+    for (uint8_t i = 0; i < bucketCount - 1; ++i) {
+        cumulative += buckets_[i];
+        if (cumulative >= rank && cumulative > 0) {
+            const unsigned long upperBound = static_cast<unsigned long>(i + 1) * bucketWidthUs_;
+            return (upperBound < maximumUs_ ? upperBound : maximumUs_);
+        }
+    }
+    return maximumUs_;
+}
+
+unsigned long LatencyHistogram::maximum() const
+{
+    return maximumUs_;
+}
+
+// Only frames that carried a change are remembered, a change that is still pending is not overwritten.
+void LatencyProbe::frameRead(const Controller &controller)
+{
+    if (pending_ || (!controller.buttonsStateChanged() && controller.analogChangeMask() == 0)) {
+        return;
+    }
+    pending_          = true;
+    frameStartedUs_   = controller.frameStartedUs();
+    frameCompletedUs_ = controller.frameCompletedUs();
+}
+
+bool LatencyProbe::pending() const
+{
+    return pending_;
+}
+
+void LatencyProbe::consumed(unsigned long timestampUs)
+{
+    if (!pending_) {
+        return;
+    }
+    pending_ = false;
+    transaction_.add(frameCompletedUs_ - frameStartedUs_);
+    pickup_.add(timestampUs - frameCompletedUs_);
+}
+
+void LatencyProbe::consumed(unsigned long timestampUs, unsigned long changeTimestampUs)
+{
+    if (!pending_) {
+        return;
+    }
+    // A change that happened after ATT went low but before the buttons were shifted out still made it into the frame.
+    poll_.add(changeTimestampUs < frameStartedUs_ ? frameStartedUs_ - changeTimestampUs : 0);
+    total_.add(timestampUs - changeTimestampUs);
+    consumed(timestampUs);
+}
+
+void LatencyProbe::reset()
+{
+    pending_ = false;
+    poll_.reset();
+    transaction_.reset();
+    pickup_.reset();
+    total_.reset();
+}
+
+void LatencyProbe::setBucketWidth(uint16_t us)
+{
+    poll_.setBucketWidth(us);
+    transaction_.setBucketWidth(us);
+    pickup_.setBucketWidth(us);
+    total_.setBucketWidth(us);
+}
+
+const LatencyHistogram &LatencyProbe::poll() const
+{
+    return poll_;
+}
+
+const LatencyHistogram &LatencyProbe::transaction() const
+{
+    return transaction_;
+}
+
+const LatencyHistogram &LatencyProbe::pickup() const
+{
+    return pickup_;
+}
+
+const LatencyHistogram &LatencyProbe::total() const
+{
+    return total_;
+}
+
+} // namespace ps2
@@ -0,0 +1,100 @@
+#include "ps2_lockstep.hpp"
+
+namespace ps2 {
+
+bool LockstepGroup::add(Controller &controller)
+{
+    if (count_ == maxControllers) {
+        return false;
+    }
+    const byte dataMask = static_cast<byte>(1u << controller.dataMask_);
+    if (count_ > 0) {
+        const Controller &leader = *controllers_[0];
+        if (controller.clockOuputRegister_ != leader.clockOuputRegister_ || controller.clockMask_ != leader.clockMask_
+            || controller.commandOutputRegister_ != leader.commandOutputRegister_
+            || controller.commandMask_ != leader.commandMask_
+            || controller.attentionOutputRegister_ != leader.attentionOutputRegister_
+            || controller.attentionMask_ != leader.attentionMask_
+            || controller.dataInputRegister_ != leader.dataInputRegister_) {
+            return false;
+        }
+        for (uint8_t i = 0; i < count_; ++i) {
+            if (dataMasks_[i] == dataMask) {
+                return false;
+            }
+        }
+    }
+    controllers_[count_] = &controller;
+    dataMasks_[count_]   = dataMask;
+    ++count_;
+    return true;
+}
+
+uint8_t LockstepGroup::size() const
+{
+    return count_;
+}
+
+void LockstepGroup::readData()
+{
+    readData(false, 0);
+}
+
+// The frame is clocked by the first controller, with its interrupt policy and bus timing. It is as long as the
+// longest frame of the group, a pad in pressure mode makes all read the aux bytes and the others ignore them. Command,
+// frame lengths and digital mode fill are the ones of Controller::readData().
+void LockstepGroup::readData(bool motor1, byte motor2)
+{
+    if (count_ == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < count_; ++i) {
+        controllers_[i]->prepareRead();
+    }
+
+    byte command[Controller::baseDataSize];
+    Controller::pollCommand(motor1, motor2, command);
+
+    Controller         &leader         = *controllers_[0];
+    const unsigned long frameStartedUs = micros();
+    const uint8_t       oldSreg        = leader.beginTransfer(TraceSource::Poll);
+    uint8_t             size           = Controller::baseDataSize;
+    for (uint8_t i = 0; i < size; ++i) {
+        shiftByte((i < Controller::baseDataSize ? command[i] : 0), i);
+        if (i == 1) {
+            size = 0;
+            for (uint8_t c = 0; c < count_; ++c) {
+                const uint8_t padSize = Controller::pollFrameSize(controllers_[c]->data_[1]);
+                size                  = (padSize > size ? padSize : size);
+            }
+        }
+    }
+    leader.endTransfer(oldSreg);
+    const unsigned long frameCompletedUs = micros();
+
+    for (uint8_t i = 0; i < count_; ++i) {
+        controllers_[i]->fillMissingSticks();
+        controllers_[i]->frameStartedUs_   = frameStartedUs;
+        controllers_[i]->frameCompletedUs_ = frameCompletedUs;
+        controllers_[i]->finishRead();
+    }
+}
+
+// Clocked by Controller::clockByte(). The port samples are only split into per-controller bytes once CLK is back high,
+// so the clock low phase does not grow with the number of controllers.
+void LockstepGroup::shiftByte(byte command, uint8_t index)
+{
+    Controller &leader = *controllers_[0];
+    byte        samples[8];
+    leader.clockByte(command, samples);
+    for (uint8_t c = 0; c < count_; ++c) {
+        controllers_[c]->data_[index] = Controller::sampledByte(samples, dataMasks_[c]);
+    }
+#ifdef PS2_TRACE
+    traceBuffer.record(leader.traceTag_, command, leader.data_[index]);
+    leader.traceTag_ &= ~TraceBuffer::frameStart;
+#endif
+    leader.byteGap();
+}
+
+} // namespace ps2
@@ -0,0 +1,79 @@
+#include "ps2_predictor.hpp"
+
+namespace ps2 {
+
+void StickPredictor::setGains(uint16_t alpha, uint16_t beta)
+{
+    alpha_ = (alpha < gainOne ? alpha : gainOne);
+    beta_  = (beta < gainOne ? beta : gainOne);
+}
+
+// In stick units, 0 disables prediction and predict() returns the last measurement.
+void StickPredictor::setOvershootLimit(byte limit)
+{
+    overshootLimit_ = limit;
+}
+
+void StickPredictor::reset()
+{
+    primed_ = false;
+}
+
+// Call after every readData(). Stale and dropout frames repeat old values and are skipped, so they don't pull the
+// velocity toward zero.
+void StickPredictor::update(const Controller &controller)
+{
+    if (controller.frameStatus() != FrameStatus::Valid) {
+        return;
+    }
+    const byte sticks[4] = { controller.analogButtonState(PSS_RX), controller.analogButtonState(PSS_RY),
+                             controller.analogButtonState(PSS_LX), controller.analogButtonState(PSS_LY) };
+    update(sticks, controller.frameCompletedUs());
+}
+
+// Sticks in PSS_RX..PSS_LY order. The first frame, and any frame after a gap longer than maxHorizonUs, restarts the
+// filter at the measurement with zero velocity. One 32-bit division per axis.
+void StickPredictor::update(const byte sticks[4], unsigned long timestampUs)
+{
+    const unsigned long elapsedUs = timestampUs - lastUs_;
+    if (primed_ && elapsedUs == 0) {
+        return;
+    }
+    const bool restart = (!primed_ || elapsedUs > maxHorizonUs);
+    lastUs_            = timestampUs;
+    primed_            = true;
+    for (uint8_t i = 0; i < 4; ++i) {
+        Axis &axis    = axes_[i];
+        axis.measured = sticks[i];
+        if (restart) {
+            axis.position = static_cast<int32_t>(sticks[i]) << 8;
+            axis.velocity = 0;
+            continue;
+        }
+        const int32_t dt        = static_cast<int32_t>(elapsedUs);
+        const int32_t predicted = axis.position + ((axis.velocity * dt) >> velocityShift);
+        const int32_t residual  = (static_cast<int32_t>(sticks[i]) << 8) - predicted;
+        axis.position           = predicted + ((residual * static_cast<int32_t>(alpha_)) >> 8);
+        axis.velocity += (residual * static_cast<int32_t>(beta_) * ((1 << velocityShift) >> 8)) / dt;
+        axis.velocity = (axis.velocity < -maxVelocity ? -maxVelocity
+                                                      : (axis.velocity > maxVelocity ? maxVelocity : axis.velocity));
+    }
+}
+
+// Timestamps before the last frame return its measurement, horizons beyond maxHorizonUs are cut to it.
+byte StickPredictor::predict(uint8_t stickId, unsigned long timestampUs) const
+{
+    const Axis &axis = axes_[stickId - PSS_RX];
+    if (!primed_ || static_cast<long>(timestampUs - lastUs_) <= 0) {
+        return axis.measured;
+    }
+    const unsigned long horizonUs = timestampUs - lastUs_;
+    const int32_t       dt        = static_cast<int32_t>(horizonUs < maxHorizonUs ? horizonUs : maxHorizonUs);
+    int32_t             value     = (axis.position + ((axis.velocity * dt) >> velocityShift) + 0x80) >> 8;
+    const int32_t       low       = static_cast<int32_t>(axis.measured) - overshootLimit_;
+    const int32_t       high      = static_cast<int32_t>(axis.measured) + overshootLimit_;
+    value                         = (value < low ? low : (value > high ? high : value));
+    return static_cast<byte>(value < 0 ? 0 : (value > 0xFF ? 0xFF : value));
+}
+
+} // namespace ps2
@@ -0,0 +1,168 @@
+#include "ps2_rumble.hpp"
+
+namespace ps2 {
+
+bool Rumble::pulse(byte level, uint16_t durationMs, bool smallMotor)
+{
+    if (smallMotor) {
+        return enqueue({ durationMs, 0, 0, RumbleShape::Linear, level != 0 });
+    }
+    return enqueue({ durationMs, level, level, RumbleShape::Linear, false });
+}
+
+bool Rumble::ramp(byte fromLevel, byte toLevel, uint16_t durationMs)
+{
+    return enqueue({ durationMs, fromLevel, toLevel, RumbleShape::Linear, false });
+}
+
+bool Rumble::decay(byte fromLevel, uint16_t durationMs)
+{
+    return enqueue({ durationMs, fromLevel, 0, RumbleShape::Decay, false });
+}
+
+// repeats == 0 plays the pattern until stop() is called.
+bool Rumble::pattern(const RumbleStep steps[], uint8_t size, uint8_t repeats)
+{
+    if (size == 0) {
+        return false;
+    }
+    return enqueue(steps, size, repeats);
+}
+
+void Rumble::stop()
+{
+    queueCount_ = 0;
+    running_    = false;
+    smallMotor_ = false;
+    level_      = 0;
+}
+
+bool Rumble::active() const
+{
+    return (running_ || queueCount_ > 0);
+}
+
+void Rumble::update(unsigned long timestampMs)
+{
+    if (!running_) {
+        lastUpdateMs_ = timestampMs;
+        if (queueCount_ == 0) {
+            return;
+        }
+        running_     = true;
+        stepIndex_   = 0;
+        repeatsLeft_ = queue_[queueHead_].repeats;
+        startStep(stepAt(queue_[queueHead_], 0));
+        return;
+    }
+
+    const unsigned long elapsedMs = timestampMs - lastUpdateMs_;
+    uint16_t            elapsed   = (elapsedMs > 0xFFFF ? 0xFFFF : elapsedMs);
+    lastUpdateMs_                 = timestampMs;
+    while (running_ && elapsed > 0) {
+        const uint16_t ms = (elapsed < remainingMs_ ? elapsed : remainingMs_);
+        advance(ms);
+        elapsed -= ms;
+        if (remainingMs_ == 0) {
+            nextStep();
+        }
+    }
+}
+
+bool Rumble::smallMotor() const
+{
+    return (running_ && smallMotor_);
+}
+
+byte Rumble::largeMotor() const
+{
+    return (running_ ? static_cast<byte>(level_ >> 8) : 0);
+}
+
+bool Rumble::enqueue(const RumbleStep &step)
+{
+    if (!enqueue(nullptr, 1, 1)) {
+        return false;
+    }
+    Effect &effect = queue_[(queueHead_ + queueCount_ - 1) % queueSize];
+    effect.step    = step;
+    return true;
+}
+
+bool Rumble::enqueue(const RumbleStep steps[], uint8_t size, uint8_t repeats)
+{
+    if (queueCount_ == queueSize) {
+        return false;
+    }
+    Effect &effect = queue_[(queueHead_ + queueCount_) % queueSize];
+    effect.steps   = steps;
+    effect.size    = size;
+    effect.repeats = repeats;
+    ++queueCount_;
+    return true;
+}
+
+// A null steps pointer means the effect's own single step, so effects stay valid when the queue is copied.
+const RumbleStep &Rumble::stepAt(const Effect &effect, uint8_t index)
+{
+    return (effect.steps != nullptr ? effect.steps[index] : effect.step);
+}
+
+// The only division happens here, once per step. Polls scale the precomputed slope by the elapsed time or shift the
+// level.
+void Rumble::startStep(const RumbleStep &step)
+{
+    shape_       = step.shape;
+    smallMotor_  = step.smallMotor;
+    targetLevel_ = step.toLevel;
+    remainingMs_ = (step.durationMs > 0 ? step.durationMs : 1);
+    level_       = static_cast<int32_t>(step.fromLevel) << 8;
+    if (shape_ == RumbleShape::Linear) {
+        slope_ = ((static_cast<int32_t>(step.toLevel) - step.fromLevel) << 8) / remainingMs_;
+    } else {
+        decayTickMs_    = remainingMs_ / decayTicksPerStep;
+        decayTickMs_    = (decayTickMs_ > 0 ? decayTickMs_ : 1);
+        decayElapsedMs_ = 0;
+    }
+}
+
+void Rumble::nextStep()
+{
+    const Effect &effect = queue_[queueHead_];
+    if (++stepIndex_ < effect.size) {
+        startStep(stepAt(effect, stepIndex_));
+        return;
+    }
+
+    stepIndex_ = 0;
+    if (effect.repeats == 0 || --repeatsLeft_ > 0) {
+        startStep(stepAt(effect, 0));
+        return;
+    }
+
+    queueHead_ = (queueHead_ + 1) % queueSize;
+    --queueCount_;
+    if (queueCount_ == 0) {
+        stop();
+        return;
+    }
+    repeatsLeft_ = queue_[queueHead_].repeats;
+    startStep(stepAt(queue_[queueHead_], 0));
+}
+
+void Rumble::advance(uint16_t ms)
+{
+    remainingMs_ -= ms;
+    if (shape_ == RumbleShape::Linear) {
+        level_ = (remainingMs_ == 0 ? static_cast<int32_t>(targetLevel_) << 8 : level_ + slope_ * ms);
+        return;
+    }
+
+    decayElapsedMs_ += ms;
+    while (decayElapsedMs_ >= decayTickMs_) {
+        decayElapsedMs_ -= decayTickMs_;
+        level_ -= level_ >> decayShift;
+    }
+}
+
+} // namespace ps2
@@ -0,0 +1,100 @@
+#include "ps2_sleep.hpp"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+
+#if PS2_SLEEP_TIMER0_COMPARE
+// Only there to wake the CPU, see IdleScheduler::sleepOnce().
+EMPTY_INTERRUPT(TIMER0_COMPB_vect);
+#endif
+
+namespace ps2 {
+
+void IdleScheduler::setPeriodUs(unsigned long us)
+{
+    periodUs_ = us;
+}
+
+// Fixed rate: each deadline is one period after the previous one, so the time spent polling doesn't add up. A caller
+// that is more than a period late starts a new schedule instead of polling in a burst to catch up.
+void IdleScheduler::sleepUntilDue()
+{
+    const unsigned long now = micros();
+    if (!scheduled_ || static_cast<long>(now - nextDueUs_) > static_cast<long>(periodUs_)) {
+        nextDueUs_ = now;
+        scheduled_ = true;
+    }
+    sleepUntil(nextDueUs_);
+    nextDueUs_ += periodUs_;
+}
+
+void IdleScheduler::sleepUntil(unsigned long deadlineUs)
+{
+    while (true) {
+        const long remainingUs = static_cast<long>(deadlineUs - micros());
+        if (remainingUs < static_cast<long>(minSleepUs)) {
+            if (remainingUs > 0) {
+                delayMicroseconds(static_cast<unsigned int>(remainingUs));
+            }
+            return;
+        }
+        sleepOnce(static_cast<unsigned long>(remainingUs));
+    }
+}
+
+void IdleScheduler::resetStats()
+{
+    statsStartUs_ = micros();
+    asleepUs_     = 0;
+    wakeups_      = 0;
+}
+
+unsigned long IdleScheduler::asleepUs() const
+{
+    return asleepUs_;
+}
+
+// Since resetStats(), or since reset.
+unsigned long IdleScheduler::awakeUs() const
+{
+    return (micros() - statsStartUs_) - asleepUs_;
+}
+
+uint16_t IdleScheduler::dutyCyclePermille() const
+{
+    const unsigned long totalUs = micros() - statsStartUs_;
+    return static_cast<uint16_t>(totalUs > 0 ? (awakeUs() * 1000ULL) / totalUs : 1000);
+}
+
+uint32_t IdleScheduler::wakeups() const
+{
+    return wakeups_;
+}
+
+// Arms compare B when the deadline comes before the next overflow. It matches up to two ticks early, never late.
+// Without compare B, minSleepUs keeps a whole overflow period ahead, so the overflow wake-up can't be late either. The
+// interrupts are enabled right before sleep_cpu(), which still executes before any pending interrupt runs, so a wake-up
+// can't slip in between.
+void IdleScheduler::sleepOnce(unsigned long remainingUs)
+{
+    const unsigned long startUs = micros();
+    const uint8_t       oldSreg = SREG;
+    cli();
+    if (config::sleepCompare && remainingUs < overflowUs) {
+        OCR0B = static_cast<uint8_t>(TCNT0 + remainingUs / timerTickUs);
+        TIFR0 = (1 << OCF0B);
+        TIMSK0 |= (1 << OCIE0B);
+    }
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    TIMSK0 &= static_cast<uint8_t>(~(1 << OCIE0B));
+    SREG = oldSreg;
+    asleepUs_ += micros() - startUs;
+    ++wakeups_;
+}
+
+} // namespace ps2
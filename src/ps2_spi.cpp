@@ -0,0 +1,149 @@
+#include "ps2_spi.hpp"
+
+#include <string.h>
+
+namespace ps2 {
+
+SpiClient::SpiClient(uint8_t selectPin, SPISettings settings, uint8_t selectDelayUs, uint8_t byteGapUs)
+    : settings_ { settings }, selectPin_ { selectPin }, selectDelayUs_ { selectDelayUs }, byteGapUs_ { byteGapUs }
+{
+}
+
+uint16_t SpiClient::transfers() const
+{
+    return transfers_;
+}
+
+unsigned long SpiClient::averageWaitUs() const
+{
+    return (transfers_ > 0 ? totalWaitUs_ / transfers_ : 0);
+}
+
+unsigned long SpiClient::maxWaitUs() const
+{
+    return maxWaitUs_;
+}
+
+void SpiClient::resetStatistics()
+{
+    transfers_   = 0;
+    totalWaitUs_ = 0;
+    maxWaitUs_   = 0;
+}
+
+void SpiClient::begin()
+{
+    digitalWrite(selectPin_, HIGH);
+    pinMode(selectPin_, OUTPUT);
+}
+
+// Devices that need a pause after select or between bytes, like the PS2 pad, get one; the others use the buffer
+// transfer.
+void SpiClient::run(SpiTransfer &transfer)
+{
+    transfer.startedUs         = micros();
+    const unsigned long waitUs = transfer.startedUs - transfer.queuedUs;
+    if (waitUs > maxWaitUs_) {
+        maxWaitUs_ = waitUs;
+    }
+    totalWaitUs_ += waitUs;
+    ++transfers_;
+
+    SPI.beginTransaction(settings_);
+    digitalWrite(selectPin_, LOW);
+    if (selectDelayUs_ > 0) {
+        delayMicroseconds(selectDelayUs_);
+    }
+    if (byteGapUs_ == 0) {
+        SPI.transfer(transfer.buffer, transfer.size);
+    } else {
+        for (uint16_t i = 0; i < transfer.size; ++i) {
+            transfer.buffer[i] = SPI.transfer(transfer.buffer[i]);
+            delayMicroseconds(byteGapUs_);
+        }
+    }
+    digitalWrite(selectPin_, HIGH);
+    SPI.endTransaction();
+}
+
+void SpiArbiter::begin(SpiClient *const clients[], uint8_t count)
+{
+    for (uint8_t i = 0; i < count; ++i) {
+        clients[i]->begin();
+    }
+    SPI.begin();
+}
+
+bool SpiArbiter::submit(SpiTransfer &transfer)
+{
+    if (count_ == queueSize) {
+        return false;
+    }
+    transfer.queuedUs                    = micros();
+    queue_[(head_ + count_) % queueSize] = &transfer;
+    ++count_;
+    return true;
+}
+
+// Transfers run in submission order, so a client waits at most for the transfers queued before it.
+bool SpiArbiter::service()
+{
+    if (count_ == 0) {
+        return false;
+    }
+    SpiTransfer &transfer = *queue_[head_];
+    head_                 = (head_ + 1) % queueSize;
+    --count_;
+    transfer.client->run(transfer);
+    if (transfer.done != nullptr) {
+        transfer.done(transfer);
+    }
+    return true;
+}
+
+uint8_t SpiArbiter::pending() const
+{
+    return count_;
+}
+
+SpiPoller::SpiPoller(SpiArbiter &arbiter, Controller &controller, uint8_t attentionPin, uint32_t clockHz)
+    : arbiter_ { arbiter },
+      controller_ { controller },
+      client_ { attentionPin, SPISettings(clockHz, LSBFIRST, SPI_MODE3), selectDelayUs, byteGapUs },
+      transfer_ { &client_, frame_, 0, frameDone, this, 0, 0 }
+{
+}
+
+// The frame is as long as the controller's current mode needs, which configure() already read back, so the first
+// pressure mode frame is clocked in full too.
+bool SpiPoller::request(bool motor1, byte motor2)
+{
+    if (pending_) {
+        return false;
+    }
+    const byte command[] = { 0x01, 0x42, 0, motor1, Controller::scaleMotor(motor2) };
+    memset(frame_, 0, sizeof(frame_));
+    memcpy(frame_, command, sizeof(command));
+    transfer_.size = controller_.frameBytes();
+    pending_       = arbiter_.submit(transfer_);
+    return pending_;
+}
+
+bool SpiPoller::pending() const
+{
+    return pending_;
+}
+
+SpiClient &SpiPoller::client()
+{
+    return client_;
+}
+
+void SpiPoller::frameDone(SpiTransfer &transfer)
+{
+    SpiPoller &poller = *static_cast<SpiPoller *>(transfer.context);
+    poller.pending_   = false;
+    poller.controller_.decodeFrame(poller.frame_, static_cast<uint8_t>(transfer.size), transfer.startedUs);
+}
+
+} // namespace ps2
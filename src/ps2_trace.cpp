@@ -0,0 +1,60 @@
+#include "ps2_trace.hpp"
+
+#ifdef PS2_TRACE
+
+namespace ps2 {
+
+TraceBuffer traceBuffer;
+
+namespace {
+
+void printHex(Print &out, byte value)
+{
+    if (value < 0x10) {
+        out.print('0');
+    }
+    out.print(value, HEX);
+}
+
+} // namespace
+
+uint8_t TraceBuffer::size() const
+{
+    return count_;
+}
+
+TraceEntry TraceBuffer::entry(uint8_t index) const
+{
+    return entries_[(head_ + capacity - count_ + index) & (capacity - 1)];
+}
+
+void TraceBuffer::clear()
+{
+    head_  = 0;
+    count_ = 0;
+}
+
+// One line per frame, each byte as command:response, e.g. "P 01:FF 42:73 00:5A ...". The first line may start in the
+// middle of a frame that was partly overwritten.
+void TraceBuffer::dump(Print &out) const
+{
+    static constexpr char sourceLetters[] = { 'C', 'T', 'P', 'E' };
+    for (uint8_t i = 0; i < count_; ++i) {
+        const TraceEntry current = entry(i);
+        if (current.tag & frameStart || i == 0) {
+            if (i > 0) {
+                out.println();
+            }
+            out.print(sourceLetters[current.tag & ~frameStart & 0x03]);
+        }
+        out.print(' ');
+        printHex(out, current.command);
+        out.print(':');
+        printHex(out, current.response);
+    }
+    out.println();
+}
+
+} // namespace ps2
+
+#endif // PS2_TRACE